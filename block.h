@@ -0,0 +1,71 @@
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include <cstdint>
+
+// block ids stored in the chunk arrays, the order matches the textures loaded in main()
+// ------------------------------------------------------------------------
+enum BlockID : std::uint8_t
+{
+    BLOCK_AIR = 0,
+    BLOCK_GRASS,
+    BLOCK_DIRT,
+    BLOCK_STONE,
+    BLOCK_DIAMOND,
+    BLOCK_COAL,
+    BLOCK_IRON,
+    BLOCK_WATER,
+    BLOCK_LEAF,
+    BLOCK_WOOD,
+    BLOCK_BEDROCK,
+    BLOCK_PLANK,
+    BLOCK_BRICK,
+    BLOCK_OAK,
+    BLOCK_GLASS,
+    BLOCK_COUNT
+};
+
+// texture of every block id, all of them are loaded into one texture array (512x512 each)
+const char* const BLOCK_TEXTURE_PATHS[BLOCK_COUNT] = {
+    nullptr, // air has no texture
+    "textures\\grassblock.jpg",
+    "textures\\dirtblock.jpg",
+    "textures\\stoneblock.jpg",
+    "textures\\diamondblock.jpg",
+    "textures\\coalblock.jpg",
+    "textures\\ironblock.jpg",
+    "textures\\waterblock.jpg",
+    "textures\\leafblock.jpg",
+    "textures\\woodblock.jpg",
+    "textures\\bedrockblock.jpg",
+    "textures\\plankblock.jpg",
+    "textures\\brickblock.jpg",
+    "textures\\oakblock.jpg",
+    "textures\\glassblock.jpg"
+};
+
+// layer of the block texture array holding the texture of a block, air has none
+inline int textureLayer(BlockID id)
+{
+    return (int)id - 1;
+}
+
+// true for every block that takes up space (everything except air)
+inline bool isSolid(BlockID id)
+{
+    return id != BLOCK_AIR;
+}
+
+// true for blocks that can be seen through, they never hide the faces of their neighbours
+inline bool isTransparent(BlockID id)
+{
+    return id == BLOCK_AIR || id == BLOCK_GLASS;
+}
+
+// true for blocks that completely hide whatever is behind them
+inline bool isOpaque(BlockID id)
+{
+    return !isTransparent(id);
+}
+
+#endif
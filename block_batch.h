@@ -0,0 +1,100 @@
+#ifndef BLOCK_BATCH_H
+#define BLOCK_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "block.h"
+#include "shader.h"
+
+// one loose block: its centre and the layer of the block texture array it shows
+struct BlockInstance
+{
+    glm::vec3 position;
+    int layer;
+};
+
+// blocks that are not part of any chunk mesh (the showcase blocks, and anything that moves on its
+// own like falling blocks, drops or placement previews), drawn with one instanced draw call per
+// flush. every material is a layer of the same texture array and the layer comes with the
+// instance, so blocks of all materials go into the same draw
+// ------------------------------------------------------------------------
+class BlockBatch
+{
+public:
+    // cubeVBO holds the 36 vertices of a unit cube around the origin as <vec3 pos, vec2 tex>, it is
+    // shared, not owned. needs a current gl context
+    // ------------------------------------------------------------------------
+    void create(unsigned int cubeVBO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+
+        // advanced once per cube instead of once per vertex
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(BlockInstance), (void*)0);
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(3);
+        glVertexAttribIPointer(3, 1, GL_INT, sizeof(BlockInstance), (void*)(3 * sizeof(float)));
+        glVertexAttribDivisor(3, 1);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    // queue a block, nothing is drawn until flush()
+    void add(const glm::vec3& position, BlockID id)
+    {
+        instances.push_back(BlockInstance{ position, textureLayer(id) });
+    }
+
+    // draw everything queued since the last flush with the cube shader (cube.vert), whose view and
+    // projection are already set. returns the number of draw calls
+    // ------------------------------------------------------------------------
+    unsigned int flush(const Shader& shader)
+    {
+        if (instances.empty()) return 0;
+
+        shader.use();
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+        // orphan the old storage like the text batch, the driver never has to wait for last frame's draw
+        size_t bytes = instances.size() * sizeof(BlockInstance);
+        if (bytes > bufferCapacity)
+            bufferCapacity = bytes;
+        glBufferData(GL_ARRAY_BUFFER, bufferCapacity, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)instances.size());
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        instances.clear();
+        return 1;
+    }
+
+    // free the gl objects, must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void destroy()
+    {
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteVertexArrays(1, &VAO);
+        instanceVBO = VAO = 0;
+    }
+
+private:
+    unsigned int VAO = 0, instanceVBO = 0;
+    size_t bufferCapacity = 0;
+    std::vector<BlockInstance> instances;
+};
+#endif
@@ -0,0 +1,496 @@
+#ifndef CHUNK_RENDERER_H
+#define CHUNK_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "shader.h"
+#include "frustum.h"
+#include "software_occlusion.h"
+#include "world.h"
+#include "mesher.h"
+#include "vertex_arena.h"
+#include "mpsc_queue.h"
+#include "thread_pool.h"
+
+// the indirect draw of gl 4.3 (ARB_multi_draw_indirect), glad is generated for 3.3 and doesn't
+// know it, ChunkRenderer::create() loads it by hand when the driver has it
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+typedef void (APIENTRY* MultiDrawArraysIndirectProc)(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+// one draw of glMultiDrawArraysIndirect, layout fixed by gl
+struct DrawArraysIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+// gpu side mesh of a single chunk, a range of the shared vertex arena
+struct ChunkMesh
+{
+    int first = 0;  // first vertex in the arena
+    int pages = 0;  // arena pages, none for an empty mesh
+    int vertexCount = 0;
+    unsigned int requestedRevision = 0; // set every time the chunk is sent to the workers
+    // occlusion query of the chunk, results are read frames later and never waited for
+    unsigned int query = 0;
+    bool queryPending = false; // issued, result not read back yet
+    bool occluded = false;     // no sample passed the depth test the last time it was asked
+    std::vector<OcclusionBox> occluders; // for the software occlusion, see findOccluders()
+};
+
+// a mesh built by a worker thread, waiting to be uploaded by the gl thread
+struct MeshResult
+{
+    glm::ivec3 coord;
+    unsigned int revision = 0;
+    ChunkMeshData mesh;
+    std::vector<OcclusionBox> occluders;
+};
+
+// uploading is the only part of meshing that has to run on the gl thread, cap it so a burst
+// of changed chunks is spread over several frames
+const int MAX_UPLOADS_PER_FRAME = 8;
+// a chunk the camera is this close to is always drawn, its box may be cut by the near plane and
+// then says hidden although the chunk is right in front of the player
+const float OCCLUSION_NEAR_MARGIN = 1.0f;
+// every chunk in the frustum gets its box tested every this many frames, hidden or not, the chunks
+// take turns so only a few boxes are drawn per frame
+const unsigned int OCCLUSION_QUERY_INTERVAL = 8;
+
+// how chunks hidden behind other geometry are found
+enum OcclusionMode
+{
+    OCCLUSION_QUERIES = 0, // gpu occlusion queries, see ChunkRenderer::draw()
+    OCCLUSION_SOFTWARE     // the chunks' solid parts rasterized on the cpu, see software_occlusion.h
+};
+
+// keeps the baked mesh of every chunk as a range of one shared vertex arena (vertex_arena.h) and
+// only rebuilds the ones whose blocks changed, meshes are built on a pool of worker threads so the
+// render loop never waits for them. the visible chunks are drawn with a single multi draw call
+// ------------------------------------------------------------------------
+class ChunkRenderer
+{
+public:
+    // create the vertex arena and the occlusion box, and pick up glMultiDrawArraysIndirect when
+    // the driver has it (load is the loader glad was initialized with). needs a current gl context
+    // ------------------------------------------------------------------------
+    void create(GLADloadproc load)
+    {
+        arena.create();
+
+        // the occlusion box goes into the arena like any mesh, at origin 0; draw() places it with
+        // the chunkOrigin uniform
+        std::vector<PackedVertex> vertices;
+        const int ao[4] = { 3, 3, 3, 3 };
+        for (int face = 0; face < FACE_COUNT; face++)
+            emitQuad(vertices, glm::ivec3(0), glm::ivec3(CHUNK_SIZE), face, BLOCK_STONE, ao);
+        boxVertexCount = (int)vertices.size();
+        boxFirst = arena.allocate(VertexArena::pagesFor(boxVertexCount), glm::ivec3(0));
+        arena.write(boxFirst, vertices);
+
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        bool indirect = major > 4 || (major == 4 && minor >= 3);
+        GLint extensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+        for (GLint i = 0; i < extensions && !indirect; i++)
+            indirect = std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_multi_draw_indirect") == 0;
+        if (indirect)
+        {
+            multiDrawArraysIndirect = (MultiDrawArraysIndirectProc)load("glMultiDrawArraysIndirect");
+            if (multiDrawArraysIndirect)
+                glGenBuffers(1, &indirectBuffer);
+        }
+    }
+
+    // true when the visible chunks go out with glMultiDrawArraysIndirect, else glMultiDrawArrays
+    bool usesIndirectDraw() const
+    {
+        return multiDrawArraysIndirect != nullptr;
+    }
+
+    // hand a snapshot of every chunk that changed since the last call to the mesh workers, then
+    // upload at most MAX_UPLOADS_PER_FRAME of the meshes they finished
+    // ------------------------------------------------------------------------
+    void update(World& world)
+    {
+        for (auto& entry : world.getChunks())
+        {
+            Chunk& chunk = *entry.second;
+            if (!chunk.dirty) continue;
+            chunk.dirty = false;
+
+            // the workers only ever see this copy, never the live world
+            std::shared_ptr<ChunkNeighborhood> snapshot = std::make_shared<ChunkNeighborhood>();
+            gatherNeighborhood(world, chunk.coord, *snapshot);
+
+            // revisions are unique across all chunks, a mesh still on its way for a chunk that was
+            // released and loaded again can't be mistaken for the new one
+            unsigned int revision = ++lastRevision;
+            meshes[chunk.coord].requestedRevision = revision;
+            MeshMode mode = meshMode;
+            MPSCQueue<MeshResult>* finished = &results;
+            workers.submit([snapshot, revision, mode, finished] {
+                MeshResult result;
+                result.coord = snapshot->coord;
+                result.revision = revision;
+                buildChunkMesh(*snapshot, result.mesh, mode);
+                findOccluders(*snapshot, result.occluders);
+                finished->push(std::move(result));
+            });
+        }
+
+        MeshResult result;
+        int uploaded = 0;
+        while (uploaded < MAX_UPLOADS_PER_FRAME && results.pop(result))
+        {
+            auto it = meshes.find(result.coord);
+            // the chunk changed again after this snapshot was taken, a newer mesh is on its way
+            if (it == meshes.end() || it->second.requestedRevision != result.revision)
+                continue;
+
+            upload(result.coord, it->second, result.mesh);
+            it->second.occluders = std::move(result.occluders);
+            uploaded++;
+        }
+    }
+
+    // free the mesh of a chunk that left the world, meshes still being built for it are dropped
+    // when they arrive
+    // ------------------------------------------------------------------------
+    void release(const glm::ivec3& coord)
+    {
+        auto it = meshes.find(coord);
+        if (it == meshes.end())
+            return;
+        arena.free(it->second.first, it->second.pages);
+        glDeleteQueries(1, &it->second.query);
+        meshes.erase(it);
+    }
+
+    // switch between the naive and the greedy mesher, every chunk gets rebuilt with the new one
+    // ------------------------------------------------------------------------
+    void setMeshMode(World& world, MeshMode mode)
+    {
+        if (mode == meshMode)
+            return;
+        meshMode = mode;
+        for (auto& entry : world.getChunks())
+            entry.second->dirty = true;
+    }
+    MeshMode getMeshMode() const
+    {
+        return meshMode;
+    }
+
+    void setOcclusionMode(OcclusionMode mode)
+    {
+        occlusionMode = mode;
+    }
+    OcclusionMode getOcclusionMode() const
+    {
+        return occlusionMode;
+    }
+    const SoftwareOcclusion& getSoftwareOcclusion() const
+    {
+        return softwareOcclusion;
+    }
+
+    // with software occlusion: hand the occluders and boxes of the chunks inside the frustum to the
+    // occlusion worker, draw() picks up what it found. call it as early in the frame as the camera
+    // allows, uploads and releases in between are fine, the worker only sees copies
+    // ------------------------------------------------------------------------
+    void beginOcclusion(const Frustum& frustum, const glm::mat4& projectionView, const glm::vec3& eye)
+    {
+        if (occlusionMode != OCCLUSION_SOFTWARE)
+            return;
+
+        softwareOcclusion.clear();
+        FrustumBatch batch;
+        const std::pair<const glm::ivec3, ChunkMesh>* batchEntries[FRUSTUM_BATCH_SIZE];
+        auto addBatch = [&]()
+        {
+            unsigned int visible = frustum.intersects(batch);
+            for (int i = 0; i < batch.count; i++)
+            {
+                if (!(visible & (1u << i)))
+                    continue;
+                const glm::ivec3& coord = batchEntries[i]->first;
+                const ChunkMesh& mesh = batchEntries[i]->second;
+                softwareOcclusion.addOccluders(mesh.occluders);
+                if (mesh.vertexCount > 0)
+                    softwareOcclusion.addCandidate(coord, OcclusionBox{ chunkMin(coord), chunkMax(coord) });
+            }
+            batch.clear();
+        };
+
+        for (const auto& entry : meshes)
+        {
+            // chunks without a mesh can still be solid inside and hide others
+            if (entry.second.vertexCount == 0 && entry.second.occluders.empty()) continue;
+
+            batchEntries[batch.count] = &entry;
+            batch.add(chunkMin(entry.first), chunkMax(entry.first));
+            if (batch.full())
+                addBatch();
+        }
+        if (batch.count > 0)
+            addBatch();
+        softwareOcclusion.begin(projectionView, eye);
+    }
+
+    // draw the chunk meshes that are inside the frustum and not hidden behind other geometry, with
+    // the given chunk shader. the chunk boxes are tested against the frustum FRUSTUM_BATCH_SIZE at a
+    // time, and every chunk that passes goes into one multi draw over the vertex arena, the shader
+    // looks the chunk origins up in the arena's origin table. the block texture array has to be
+    // bound to unit 0 already, it is never rebound here. returns the number of draw calls issued
+    //
+    // with OCCLUSION_SOFTWARE the chunks found hidden by the worker started in beginOcclusion() are
+    // skipped. otherwise occlusion works with GL_ANY_SAMPLES_PASSED queries on the chunk boxes and
+    // never waits for a result: a chunk goes by the last result read back, so it is dropped from the
+    // multi draw, or comes back into it, a few frames after its box test. the boxes whose turn it is
+    // (see OCCLUSION_QUERY_INTERVAL) are drawn back to back after the multi draw, against the depth
+    // of the chunks drawn this frame
+    // ------------------------------------------------------------------------
+    unsigned int draw(const Shader& shader, const Frustum& frustum, const glm::vec3& eye, CullStats& stats)
+    {
+        unsigned int drawCalls = 0;
+        if (originProgram != shader.ID)
+        {
+            chunkOrigin = shader.uniform("chunkOrigin");
+            originProgram = shader.ID;
+        }
+        occlusionTests.clear();
+        visibleFirsts.clear();
+        visibleCounts.clear();
+        const bool queries = occlusionMode == OCCLUSION_QUERIES;
+        if (!queries)
+            softwareOcclusion.finish();
+        frame++;
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, arena.originTable());
+        glActiveTexture(GL_TEXTURE0);
+        glBindVertexArray(arena.vertexArray());
+        // added to the origin from the table, only the occlusion boxes need it
+        shader.setVec3(chunkOrigin, glm::vec3(0.0f));
+
+        FrustumBatch batch;
+        ChunkMesh* batchMeshes[FRUSTUM_BATCH_SIZE];
+        glm::ivec3 batchCoords[FRUSTUM_BATCH_SIZE];
+        auto drawBatch = [&]()
+        {
+            unsigned int visible = frustum.intersects(batch);
+            for (int i = 0; i < batch.count; i++)
+            {
+                if (!(visible & (1u << i)))
+                {
+                    stats.culled++;
+                    continue;
+                }
+
+                ChunkMesh& mesh = *batchMeshes[i];
+                if (!queries && softwareOcclusion.isHidden(batchCoords[i]))
+                {
+                    stats.occluded++;
+                    continue;
+                }
+                collectQuery(mesh);
+                const bool nearEye = containsEye(batchCoords[i], eye);
+                if (nearEye || !queries)
+                    mesh.occluded = false;
+                // the chunks take turns, a few box tests a frame whether they were hidden or not
+                if (queries && !mesh.queryPending && !nearEye
+                    && (frame + (unsigned int)ChunkCoordHash()(batchCoords[i])) % OCCLUSION_QUERY_INTERVAL == 0)
+                    occlusionTests.push_back(std::make_pair(batchCoords[i], &mesh));
+                if (mesh.occluded)
+                {
+                    stats.occluded++;
+                    continue;
+                }
+
+                stats.visible++;
+                visibleFirsts.push_back(mesh.first);
+                visibleCounts.push_back(mesh.vertexCount);
+            }
+            batch.clear();
+        };
+
+        for (auto& entry : meshes)
+        {
+            ChunkMesh& mesh = entry.second;
+            if (mesh.vertexCount == 0) continue;
+
+            batchMeshes[batch.count] = &mesh;
+            batchCoords[batch.count] = entry.first;
+            batch.add(chunkMin(entry.first), chunkMax(entry.first));
+            if (batch.full())
+                drawBatch();
+        }
+        if (batch.count > 0)
+            drawBatch();
+        drawCalls += drawVisible();
+
+        if (!occlusionTests.empty())
+        {
+            // boxes only test against the depth buffer, they must not show up or hide anything. a
+            // visible chunk's own faces can lie right on its box, those samples have to pass
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glDepthMask(GL_FALSE);
+            glDepthFunc(GL_LEQUAL);
+            for (const auto& test : occlusionTests)
+            {
+                shader.setVec3(chunkOrigin, glm::vec3(test.first * CHUNK_SIZE));
+                glBeginQuery(GL_ANY_SAMPLES_PASSED, test.second->query);
+                glDrawArrays(GL_TRIANGLES, boxFirst, boxVertexCount);
+                glEndQuery(GL_ANY_SAMPLES_PASSED);
+                test.second->queryPending = true;
+                drawCalls++;
+            }
+            glDepthFunc(GL_LESS);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthMask(GL_TRUE);
+        }
+        glBindVertexArray(0);
+        return drawCalls;
+    }
+
+    // the space a chunk takes up, blocks are unit cubes centred on their integer position
+    static glm::vec3 chunkMin(const glm::ivec3& coord)
+    {
+        return glm::vec3(coord * CHUNK_SIZE) - 0.5f;
+    }
+    static glm::vec3 chunkMax(const glm::ivec3& coord)
+    {
+        return chunkMin(coord) + (float)CHUNK_SIZE;
+    }
+
+    // total number of vertices of all uploaded chunk meshes
+    // ------------------------------------------------------------------------
+    int vertexCount() const
+    {
+        int count = 0;
+        for (const auto& entry : meshes)
+            count += entry.second.vertexCount;
+        return count;
+    }
+
+    // de-allocate all chunk meshes, has to happen while the gl context is still alive
+    // ------------------------------------------------------------------------
+    void destroy()
+    {
+        for (auto& entry : meshes)
+            glDeleteQueries(1, &entry.second.query);
+        meshes.clear();
+        arena.destroy();
+        glDeleteBuffers(1, &indirectBuffer);
+        indirectBuffer = 0;
+    }
+
+private:
+    std::unordered_map<glm::ivec3, ChunkMesh, ChunkCoordHash> meshes;
+    MeshMode meshMode = MESH_NAIVE;
+    OcclusionMode occlusionMode = OCCLUSION_QUERIES;
+    unsigned int lastRevision = 0;
+    VertexArena arena;
+    // a chunk sized box in the packed vertex format, drawn for the occlusion tests
+    int boxFirst = 0;
+    int boxVertexCount = 0;
+    // looked up the first time draw() gets a shader, not every frame
+    Shader::Uniform chunkOrigin;
+    unsigned int originProgram = 0;
+    unsigned int frame = 0;
+    // filled every frame, kept to reuse their memory
+    std::vector<std::pair<glm::ivec3, ChunkMesh*>> occlusionTests; // chunks whose box is tested this frame
+    std::vector<GLint> visibleFirsts;
+    std::vector<GLsizei> visibleCounts;
+    std::vector<DrawArraysIndirectCommand> commands;
+    // null when the driver has no indirect draws
+    MultiDrawArraysIndirectProc multiDrawArraysIndirect = nullptr;
+    unsigned int indirectBuffer = 0;
+    SoftwareOcclusion softwareOcclusion;
+    // finished meshes come back through a lock-free queue, the pool is declared last so
+    // its threads are joined before the queue goes away
+    MPSCQueue<MeshResult> results;
+    ThreadPool workers{ ThreadPool::meshThreadCount() };
+
+    void upload(const glm::ivec3& coord, ChunkMesh& mesh, const ChunkMeshData& data)
+    {
+        if (mesh.query == 0)
+            glGenQueries(1, &mesh.query);
+
+        // a mesh keeps its range as long as it needs the same number of pages
+        const int pages = VertexArena::pagesFor(data.vertexCount());
+        if (pages != mesh.pages)
+        {
+            arena.free(mesh.first, mesh.pages);
+            mesh.first = pages > 0 ? arena.allocate(pages, coord * CHUNK_SIZE) : 0;
+            mesh.pages = pages;
+        }
+        if (pages > 0)
+            arena.write(mesh.first, data.vertices);
+
+        mesh.vertexCount = data.vertexCount();
+        // new geometry, whatever was hiding the old one says nothing about it
+        mesh.occluded = false;
+    }
+
+    // every visible chunk in one go
+    // ------------------------------------------------------------------------
+    unsigned int drawVisible()
+    {
+        if (visibleFirsts.empty())
+            return 0;
+
+        if (multiDrawArraysIndirect)
+        {
+            commands.clear();
+            for (size_t i = 0; i < visibleFirsts.size(); i++)
+                commands.push_back(DrawArraysIndirectCommand{ (GLuint)visibleCounts[i], 1, (GLuint)visibleFirsts[i], 0 });
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+            // orphaned like the streaming buffers of the text and block batches
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawArraysIndirectCommand), commands.data(), GL_STREAM_DRAW);
+            multiDrawArraysIndirect(GL_TRIANGLES, (void*)0, (GLsizei)commands.size(), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+        else
+            glMultiDrawArrays(GL_TRIANGLES, visibleFirsts.data(), visibleCounts.data(), (GLsizei)visibleFirsts.size());
+        return 1;
+    }
+
+    // read the result of the last query of the mesh if the gpu has it ready, never waits for it
+    static void collectQuery(ChunkMesh& mesh)
+    {
+        if (!mesh.queryPending)
+            return;
+        GLuint available = 0;
+        glGetQueryObjectuiv(mesh.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+        GLuint anySamples = 0;
+        glGetQueryObjectuiv(mesh.query, GL_QUERY_RESULT, &anySamples);
+        mesh.occluded = anySamples == 0;
+        mesh.queryPending = false;
+    }
+
+    static bool containsEye(const glm::ivec3& coord, const glm::vec3& eye)
+    {
+        const glm::vec3 min = chunkMin(coord) - OCCLUSION_NEAR_MARGIN;
+        const glm::vec3 max = chunkMax(coord) + OCCLUSION_NEAR_MARGIN;
+        return eye.x >= min.x && eye.y >= min.y && eye.z >= min.z && eye.x <= max.x && eye.y <= max.y && eye.z <= max.z;
+    }
+};
+#endif
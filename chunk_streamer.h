@@ -0,0 +1,221 @@
+#ifndef CHUNK_STREAMER_H
+#define CHUNK_STREAMER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "world.h"
+#include "terrain.h"
+#include "structures.h"
+#include "mpsc_queue.h"
+#include "thread_pool.h"
+
+// chunk columns within this many columns of the player are kept loaded
+const int STREAM_LOAD_RADIUS = 6;
+// columns are only dropped once they are this much further away, so walking back and forth over
+// a column border doesn't generate and drop the same ring over and over
+const int STREAM_UNLOAD_MARGIN = 2;
+// work per update: columns sent to the workers, generated columns put into the world, and columns
+// dropped. inserting marks chunks dirty for the mesher, so this also spreads the meshing out
+const int STREAM_MAX_REQUESTS_PER_UPDATE = 4;
+const int STREAM_MAX_INSERTS_PER_UPDATE = 2;
+const int STREAM_MAX_UNLOADS_PER_UPDATE = 4;
+// columns on the workers at once, a player running ahead doesn't pile up a backlog
+const int STREAM_MAX_PENDING = 16;
+
+// a column finished by a worker, waiting to go into the world on the main thread
+struct StreamedColumn
+{
+    glm::ivec3 key; // StructureQueue::columnKey
+    TerrainColumn column;
+};
+
+// keeps the chunk columns around the player generated and drops the far ones, so the world has no
+// edge while memory stays proportional to the view distance. columns are generated on a pool of
+// workers and only touch the world on the thread calling update, nearest and in-view first.
+// dropped columns are generated again from the seed when the player comes back, blocks the player
+// changed in them are not kept
+// ------------------------------------------------------------------------
+class ChunkStreamer
+{
+public:
+    explicit ChunkStreamer(const TerrainGenerator& generator, int loadRadius = STREAM_LOAD_RADIUS)
+        : generator(generator), loadRadius(loadRadius) {}
+
+    // one step of streaming around position, front is the view direction. the coordinates of dropped
+    // chunks are appended to unloaded, so whoever keeps per chunk data (the renderer) can free it
+    // ------------------------------------------------------------------------
+    void update(World& world, const glm::vec3& position, const glm::vec3& front, std::vector<glm::ivec3>& unloaded)
+    {
+        const glm::ivec3 center = centerColumn(position);
+        unloadFar(world, center, STREAM_MAX_UNLOADS_PER_UPDATE, unloaded);
+        insertFinished(world, center, STREAM_MAX_INSERTS_PER_UPDATE);
+        requestMissing(center, front, std::min(STREAM_MAX_REQUESTS_PER_UPDATE, STREAM_MAX_PENDING - pendingColumns()));
+    }
+
+    // like update, but the columns requested are waited for and all go into the world right away, in
+    // a fixed order. which columns exist after a number of steps then doesn't depend on how fast the
+    // workers are, for headless runs that have to give the same result every time
+    // ------------------------------------------------------------------------
+    void updateAndWait(World& world, const glm::vec3& position, const glm::vec3& front, std::vector<glm::ivec3>& unloaded)
+    {
+        const glm::ivec3 center = centerColumn(position);
+        unloadFar(world, center, STREAM_MAX_UNLOADS_PER_UPDATE, unloaded);
+        requestMissing(center, front, STREAM_MAX_REQUESTS_PER_UPDATE);
+        workers.wait();
+        insertAll(world, center);
+    }
+
+    // generate every column within the load radius of position and wait for all of them, for the
+    // world the player starts in
+    // ------------------------------------------------------------------------
+    void fill(World& world, const glm::vec3& position)
+    {
+        const glm::ivec3 center = centerColumn(position);
+        const int everything = (loadRadius * 2 + 1) * (loadRadius * 2 + 1);
+        requestMissing(center, glm::vec3(0.0f), everything);
+        workers.wait();
+        insertAll(world, center);
+    }
+
+    int loadedColumns() const
+    {
+        return (int)loaded.size();
+    }
+    int pendingColumns() const
+    {
+        return (int)requested.size();
+    }
+
+private:
+    const TerrainGenerator& generator;
+    int loadRadius;
+    std::unordered_set<glm::ivec3, ChunkCoordHash> loaded;    // columns in the world
+    std::unordered_set<glm::ivec3, ChunkCoordHash> requested; // columns the workers are generating
+    StructureQueue structures;
+    // like the chunk renderer: results come back through a lock-free queue, the pool is declared
+    // last so its threads are joined before the queue goes away
+    MPSCQueue<StreamedColumn> finished;
+    ThreadPool workers{ ThreadPool::terrainThreadCount() };
+
+    static glm::ivec3 centerColumn(const glm::vec3& position)
+    {
+        glm::ivec3 block = worldToBlock(position);
+        return StructureQueue::columnKey(block.x >> CHUNK_SHIFT, block.z >> CHUNK_SHIFT);
+    }
+
+    // squared distance in columns, round areas instead of squares
+    static int distanceSquared(const glm::ivec3& a, const glm::ivec3& b)
+    {
+        int dx = a.x - b.x, dz = a.z - b.z;
+        return dx * dx + dz * dz;
+    }
+
+    bool inRange(const glm::ivec3& key, const glm::ivec3& center, int radius) const
+    {
+        return distanceSquared(key, center) <= radius * radius;
+    }
+
+    // ------------------------------------------------------------------------
+    void unloadFar(World& world, const glm::ivec3& center, int budget, std::vector<glm::ivec3>& unloaded)
+    {
+        const int unloadRadius = loadRadius + STREAM_UNLOAD_MARGIN;
+        for (auto it = loaded.begin(); it != loaded.end() && budget > 0;)
+        {
+            if (inRange(*it, center, unloadRadius))
+            {
+                ++it;
+                continue;
+            }
+            world.removeColumn(it->x, it->z, unloaded);
+            structures.columnUnloaded(it->x, it->z);
+            it = loaded.erase(it);
+            budget--;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    void insertFinished(World& world, const glm::ivec3& center, int budget)
+    {
+        StreamedColumn result;
+        while (budget > 0 && finished.pop(result))
+            if (insertColumn(world, center, result))
+                budget--;
+    }
+
+    // every finished column, sorted by column instead of in the order the workers got done, trees
+    // crossing into a neighbour then always land the same way
+    void insertAll(World& world, const glm::ivec3& center)
+    {
+        std::vector<StreamedColumn> columns;
+        StreamedColumn result;
+        while (finished.pop(result))
+            columns.push_back(std::move(result));
+        std::sort(columns.begin(), columns.end(), [](const StreamedColumn& a, const StreamedColumn& b) {
+            return a.key.x != b.key.x ? a.key.x < b.key.x : a.key.z < b.key.z;
+        });
+        for (StreamedColumn& column : columns)
+            insertColumn(world, center, column);
+    }
+
+    // false when the column was dropped because the player moved on while it was generated
+    bool insertColumn(World& world, const glm::ivec3& center, StreamedColumn& result)
+    {
+        requested.erase(result.key);
+        if (!inRange(result.key, center, loadRadius + STREAM_UNLOAD_MARGIN))
+            return false;
+
+        for (std::unique_ptr<Chunk>& chunk : result.column.chunks)
+            world.insertChunk(std::move(chunk));
+        structures.columnGenerated(world, result.key.x, result.key.z, result.column.outside);
+        loaded.insert(result.key);
+        return true;
+    }
+
+    // send the missing columns within the load radius to the workers, closest first. columns in
+    // front of the player count as closer than the ones behind, up to half their distance
+    // ------------------------------------------------------------------------
+    void requestMissing(const glm::ivec3& center, const glm::vec3& front, int budget)
+    {
+        glm::vec3 ahead(front.x, 0.0f, front.z);
+        float aheadLength = glm::length(ahead);
+        ahead = aheadLength > 0.0f ? ahead / aheadLength : glm::vec3(0.0f);
+
+        std::vector<std::pair<float, glm::ivec3>> missing;
+        for (int dz = -loadRadius; dz <= loadRadius; dz++)
+            for (int dx = -loadRadius; dx <= loadRadius; dx++)
+            {
+                glm::ivec3 key = StructureQueue::columnKey(center.x + dx, center.z + dz);
+                if (!inRange(key, center, loadRadius) || loaded.count(key) || requested.count(key))
+                    continue;
+                float distance = std::sqrt((float)(dx * dx + dz * dz));
+                float facing = distance > 0.0f ? (dx * ahead.x + dz * ahead.z) / distance : 1.0f;
+                missing.push_back(std::make_pair(distance * (1.0f - 0.25f * (facing + 1.0f)), key));
+            }
+
+        budget = std::max(0, std::min(budget, (int)missing.size()));
+        std::partial_sort(missing.begin(), missing.begin() + budget, missing.end(),
+            [](const std::pair<float, glm::ivec3>& a, const std::pair<float, glm::ivec3>& b) { return a.first < b.first; });
+
+        for (int i = 0; i < budget; i++)
+        {
+            const glm::ivec3 key = missing[i].second;
+            requested.insert(key);
+            const TerrainGenerator* terrain = &generator;
+            MPSCQueue<StreamedColumn>* results = &finished;
+            workers.submit([terrain, results, key] {
+                StreamedColumn result;
+                result.key = key;
+                result.column = terrain->generateColumn(key.x, key.z);
+                results->push(std::move(result));
+            });
+        }
+    }
+};
+#endif
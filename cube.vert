@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per instance, see BlockBatch in block_batch.h
+layout (location = 2) in vec3 aOffset;
+layout (location = 3) in int aLayer;
+
+out vec2 TexCoord;
+out float Shade;
+flat out int Layer;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * view * vec4(aPos + aOffset, 1.0f);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	Shade = 1.0;
+	Layer = aLayer;
+}
@@ -0,0 +1,188 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+// boxes are tested four at a time with SSE2 (two registers per batch), or all eight at once when the
+// build targets AVX (/arch:AVX, -mavx). define FRUSTUM_NO_SIMD to always use the scalar test
+#if !defined(FRUSTUM_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__))
+#define FRUSTUM_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define FRUSTUM_SIMD_X86 0
+#endif
+
+// boxes in one FrustumBatch
+const int FRUSTUM_BATCH_SIZE = 8;
+
+// how many boxes the culling tests let through and how many they threw away
+struct CullStats
+{
+    unsigned int visible = 0;
+    unsigned int culled = 0;   // outside the frustum
+    unsigned int occluded = 0; // inside, but hidden behind other geometry
+};
+
+// up to FRUSTUM_BATCH_SIZE axis aligned boxes as centre and half size, every component in its own
+// array so a whole batch loads straight into simd registers. unused slots are empty boxes far
+// behind everything, they never come out visible
+// ------------------------------------------------------------------------
+struct FrustumBatch
+{
+    alignas(32) float centerX[FRUSTUM_BATCH_SIZE];
+    alignas(32) float centerY[FRUSTUM_BATCH_SIZE];
+    alignas(32) float centerZ[FRUSTUM_BATCH_SIZE];
+    alignas(32) float extentX[FRUSTUM_BATCH_SIZE];
+    alignas(32) float extentY[FRUSTUM_BATCH_SIZE];
+    alignas(32) float extentZ[FRUSTUM_BATCH_SIZE];
+    int count = 0;
+
+    FrustumBatch()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < FRUSTUM_BATCH_SIZE; i++)
+        {
+            centerX[i] = centerY[i] = centerZ[i] = NAN;
+            extentX[i] = extentY[i] = extentZ[i] = 0.0f;
+        }
+        count = 0;
+    }
+
+    bool full() const
+    {
+        return count == FRUSTUM_BATCH_SIZE;
+    }
+
+    void add(const glm::vec3& min, const glm::vec3& max)
+    {
+        centerX[count] = (min.x + max.x) * 0.5f;
+        centerY[count] = (min.y + max.y) * 0.5f;
+        centerZ[count] = (min.z + max.z) * 0.5f;
+        extentX[count] = (max.x - min.x) * 0.5f;
+        extentY[count] = (max.y - min.y) * 0.5f;
+        extentZ[count] = (max.z - min.z) * 0.5f;
+        count++;
+    }
+};
+
+// the six planes of the view volume of a projection * view matrix (Gribb & Hartmann). a point p
+// is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+// ------------------------------------------------------------------------
+class Frustum
+{
+public:
+    Frustum() = default;
+
+    explicit Frustum(const glm::mat4& projectionView)
+    {
+        // glm matrices are column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++)
+            rows[i] = glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]);
+
+        planes[0] = rows[3] + rows[0]; // left
+        planes[1] = rows[3] - rows[0]; // right
+        planes[2] = rows[3] + rows[1]; // bottom
+        planes[3] = rows[3] - rows[1]; // top
+        planes[4] = rows[3] + rows[2]; // near
+        planes[5] = rows[3] - rows[2]; // far
+    }
+
+    // false when the box is completely outside one of the planes. boxes close to a corner of the
+    // frustum can pass without being visible, never the other way round
+    // ------------------------------------------------------------------------
+    bool intersects(const glm::vec3& min, const glm::vec3& max) const
+    {
+        const glm::vec3 center = (min + max) * 0.5f;
+        const glm::vec3 extent = (max - min) * 0.5f;
+        for (const glm::vec4& plane : planes)
+        {
+            // distance of the centre plus how far the box reaches towards the plane
+            float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            float reach = std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+            if (distance + reach < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    // the same test for every box of the batch, bit i of the result is set when box i may be visible
+    // ------------------------------------------------------------------------
+    unsigned int intersects(const FrustumBatch& batch) const
+    {
+#if FRUSTUM_SIMD_X86 && defined(__AVX__)
+        return intersectsAVX(batch);
+#elif FRUSTUM_SIMD_X86
+        return intersectsSSE2(batch, 0) | (intersectsSSE2(batch, 4) << 4);
+#else
+        unsigned int visible = 0;
+        for (int i = 0; i < batch.count; i++)
+        {
+            glm::vec3 center(batch.centerX[i], batch.centerY[i], batch.centerZ[i]);
+            glm::vec3 extent(batch.extentX[i], batch.extentY[i], batch.extentZ[i]);
+            if (intersects(center - extent, center + extent))
+                visible |= 1u << i;
+        }
+        return visible;
+#endif
+    }
+
+private:
+    glm::vec4 planes[6];
+
+#if FRUSTUM_SIMD_X86
+    // boxes first .. first + 3. a box is visible unless one plane has it completely outside; the
+    // NaN centres of unused slots fail every comparison, so they never count as inside
+    unsigned int intersectsSSE2(const FrustumBatch& batch, int first) const
+    {
+        const __m128 cx = _mm_load_ps(batch.centerX + first);
+        const __m128 cy = _mm_load_ps(batch.centerY + first);
+        const __m128 cz = _mm_load_ps(batch.centerZ + first);
+        const __m128 ex = _mm_load_ps(batch.extentX + first);
+        const __m128 ey = _mm_load_ps(batch.extentY + first);
+        const __m128 ez = _mm_load_ps(batch.extentZ + first);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : planes)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+                                         _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w)));
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(plane.x)), ex), _mm_mul_ps(_mm_set1_ps(std::fabs(plane.y)), ey)),
+                                      _mm_mul_ps(_mm_set1_ps(std::fabs(plane.z)), ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+        }
+        return (unsigned int)_mm_movemask_ps(inside);
+    }
+#endif
+
+#if FRUSTUM_SIMD_X86 && defined(__AVX__)
+    // all eight boxes in one go, same test as intersectsSSE2
+    unsigned int intersectsAVX(const FrustumBatch& batch) const
+    {
+        const __m256 cx = _mm256_load_ps(batch.centerX);
+        const __m256 cy = _mm256_load_ps(batch.centerY);
+        const __m256 cz = _mm256_load_ps(batch.centerZ);
+        const __m256 ex = _mm256_load_ps(batch.extentX);
+        const __m256 ey = _mm256_load_ps(batch.extentY);
+        const __m256 ez = _mm256_load_ps(batch.extentZ);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : planes)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), cx), _mm256_mul_ps(_mm256_set1_ps(plane.y), cy)),
+                                            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), cz), _mm256_set1_ps(plane.w)));
+            __m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.x)), ex), _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.y)), ey)),
+                                         _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.z)), ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        return (unsigned int)_mm256_movemask_ps(inside);
+    }
+#endif
+};
+#endif
@@ -0,0 +1,293 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "world.h"
+#include "terrain.h"
+#include "chunk_streamer.h"
+#include "frustum.h"
+#include "software_occlusion.h"
+#include "raycast.h"
+#include "simulation.h"
+#include "thread_pool.h"
+
+// the world without a window or gl context: terrain streamed around the player, ticks, picking and block edits
+// driven by a script, one command per line ('#' starts a comment)
+//
+//   tick <n>              run n simulation ticks with the current input
+//   walk <x> <z>          horizontal walk velocity in blocks per second
+//   jump <0|1>            hold or release jump
+//   look <yaw> <pitch>    view direction in degrees, same convention as the camera
+//   break                 remove the block the player looks at
+//   place <id>            place block id against the face the player looks at
+//   set <x> <y> <z> <id>  write a block directly
+//   print                 print the player state
+// ------------------------------------------------------------------------
+
+// soak test used when no script is given: walk in a square, jumping, digging and building
+const char* const HEADLESS_DEFAULT_SCRIPT =
+    "look -90 -45\n"
+    "walk 4 0\n  jump 1\n tick 120\n jump 0\n break\n place 3\n"
+    "walk 0 4\n  tick 120\n break\n place 12\n"
+    "walk -4 0\n tick 120\n look 0 -60\n break\n break\n"
+    "walk 0 -4\n tick 120\n place 14\n"
+    "walk 0 0\n  tick 600\n print\n";
+
+// direction the camera looks at for the given yaw and pitch (degrees)
+inline glm::vec3 lookDirection(float yaw, float pitch)
+{
+    glm::vec3 front;
+    front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    front.y = sin(glm::radians(pitch));
+    front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    return glm::normalize(front);
+}
+
+// fingerprint of every block in the world, independent of the order the chunks are stored in
+inline std::uint64_t worldChecksum(const World& world)
+{
+    std::vector<std::uint64_t> chunkHashes;
+    for (const auto& entry : world.getChunks())
+    {
+        const Chunk& chunk = *entry.second;
+        // FNV-1a over the coordinate and the blocks
+        std::uint64_t hash = 14695981039346656037ull;
+        const int coord[3] = { chunk.coord.x, chunk.coord.y, chunk.coord.z };
+        const unsigned char* bytes[2] = { (const unsigned char*)coord, (const unsigned char*)chunk.blocks };
+        const size_t sizes[2] = { sizeof(coord), sizeof(chunk.blocks) };
+        for (int part = 0; part < 2; part++)
+            for (size_t i = 0; i < sizes[part]; i++)
+                hash = (hash ^ bytes[part][i]) * 1099511628211ull;
+        chunkHashes.push_back(hash);
+    }
+    std::sort(chunkHashes.begin(), chunkHashes.end());
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::uint64_t chunkHash : chunkHashes)
+        hash = (hash ^ chunkHash) * 1099511628211ull;
+    return hash;
+}
+
+// ------------------------------------------------------------------------
+inline int runHeadless(std::istream& script, unsigned int seed, float reach)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    World world;
+    TerrainGenerator generator(seed);
+    ChunkStreamer streamer(generator);
+    std::vector<glm::ivec3> unloaded;
+    Simulation simulation;
+    PlayerInput input;
+    glm::vec3 front = lookDirection(-90.0f, 0.0f);
+    unsigned long long edits = 0, picks = 0;
+
+    Clock::time_point start = Clock::now();
+    streamer.fill(world, glm::vec3(0.0f));
+    double generateSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    simulation.reset(spawnPosition(world, generator, 0, 0));
+
+    double tickSeconds = 0.0;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(script, line))
+    {
+        lineNumber++;
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string command;
+        if (!(words >> command))
+            continue;
+
+        if (command == "tick")
+        {
+            int count = 0;
+            words >> count;
+            Clock::time_point tickStart = Clock::now();
+            for (int i = 0; i < count; i++)
+            {
+                // one streaming step per tick, like once per frame in the window, but waiting for the
+                // workers so a script gives the same world on every run and machine
+                simulation.tick(world, input);
+                streamer.updateAndWait(world, simulation.interpolatedEye(1.0f), front, unloaded);
+                unloaded.clear();
+            }
+            tickSeconds += std::chrono::duration<double>(Clock::now() - tickStart).count();
+        }
+        else if (command == "walk")
+        {
+            float x = 0.0f, z = 0.0f;
+            words >> x >> z;
+            input.walkVelocity = glm::vec3(x, 0.0f, z);
+        }
+        else if (command == "jump")
+        {
+            int held = 0;
+            words >> held;
+            input.jump = held != 0;
+        }
+        else if (command == "look")
+        {
+            float yaw = 0.0f, pitch = 0.0f;
+            words >> yaw >> pitch;
+            front = lookDirection(yaw, pitch);
+        }
+        else if (command == "break" || command == "place")
+        {
+            int id = BLOCK_DIRT;
+            words >> id;
+            picks++;
+            RaycastHit hit;
+            if (!raycastBlocks(world, simulation.interpolatedEye(1.0f), front, reach, &hit))
+                continue;
+            if (command == "break")
+            {
+                world.setBlock(hit.block, BLOCK_AIR);
+                edits++;
+            }
+            else if (id > BLOCK_AIR && id < BLOCK_COUNT && !world.isSolidAt(hit.previous)
+                && !overlapsBlock(simulation.player.bounds(), hit.previous))
+            {
+                world.setBlock(hit.previous, (BlockID)id);
+                edits++;
+            }
+        }
+        else if (command == "set")
+        {
+            int x = 0, y = 0, z = 0, id = 0;
+            words >> x >> y >> z >> id;
+            if (id >= BLOCK_AIR && id < BLOCK_COUNT)
+            {
+                world.setBlock(x, y, z, (BlockID)id);
+                edits++;
+            }
+        }
+        else if (command == "print")
+        {
+            const PlayerBody& player = simulation.player;
+            std::cout << "tick " << simulation.tickCount
+                      << " position " << player.position.x << " " << player.position.y << " " << player.position.z
+                      << " velocity " << player.velocity.x << " " << player.velocity.y << " " << player.velocity.z
+                      << (player.onGround ? " on ground" : " in air") << std::endl;
+        }
+        else
+        {
+            std::cout << "ERROR::HEADLESS: unknown command '" << command << "' on line " << lineNumber << std::endl;
+            return 1;
+        }
+    }
+
+    double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "chunks: " << world.getChunks().size() << " in " << streamer.loadedColumns() << " columns"
+              << ", checksum " << std::hex << worldChecksum(world) << std::dec
+              << ", terrain: " << generateSeconds * 1000.0 << " ms" << std::endl;
+    std::cout << "ticks: " << simulation.tickCount << " in " << tickSeconds * 1000.0 << " ms";
+    if (tickSeconds > 0.0)
+        std::cout << " (" << simulation.tickCount / tickSeconds << " ticks/s)";
+    std::cout << std::endl;
+    std::cout << "picks: " << picks << ", edits: " << edits
+              << ", total: " << totalSeconds * 1000.0 << " ms" << std::endl;
+    return 0;
+}
+
+// generate the same terrain with one worker and with all of them, report chunks per second and
+// check that both runs built exactly the same blocks
+// ------------------------------------------------------------------------
+inline int runTerrainBenchmark(unsigned int seed, int radius)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    TerrainGenerator generator(seed);
+    const unsigned int threadCounts[2] = { 1, std::max(1u, std::thread::hardware_concurrency()) };
+    std::uint64_t checksums[2] = {};
+    for (int run = 0; run < 2; run++)
+    {
+        World world;
+        StructureQueue structures;
+        ThreadPool workers(threadCounts[run]);
+        Clock::time_point start = Clock::now();
+        int chunks = generateTerrain(world, generator, structures, workers, radius);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        checksums[run] = worldChecksum(world);
+
+        double chunksPerSecond = seconds > 0.0 ? chunks / seconds : 0.0;
+        std::cout << "terrain: " << chunks << " chunks on " << threadCounts[run] << " thread(s) in "
+                  << seconds * 1000.0 << " ms, " << chunksPerSecond << " chunks/s, "
+                  << chunksPerSecond / threadCounts[run] << " chunks/s per core, checksum "
+                  << std::hex << checksums[run] << std::dec << std::endl;
+    }
+    if (checksums[0] != checksums[1])
+    {
+        std::cout << "ERROR::TERRAIN: generation is not deterministic across thread counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// software occlusion culling of generated terrain seen from the surface and from underground, in
+// four directions each. reports the chunks in the frustum, how many of them are hidden and the cost
+// ------------------------------------------------------------------------
+inline int runOcclusionBenchmark(unsigned int seed, int radius)
+{
+    World world;
+    TerrainGenerator generator(seed);
+    StructureQueue structures;
+    ThreadPool workers;
+    generateTerrain(world, generator, structures, workers, radius);
+
+    // occluders of every chunk, found the way the mesh workers find them
+    std::vector<std::pair<glm::ivec3, std::vector<OcclusionBox>>> chunks;
+    std::unique_ptr<ChunkNeighborhood> neighborhood(new ChunkNeighborhood());
+    for (const auto& entry : world.getChunks())
+    {
+        if (entry.second->solidCount == 0)
+            continue;
+        gatherNeighborhood(world, entry.first, *neighborhood);
+        chunks.push_back(std::make_pair(entry.first, std::vector<OcclusionBox>()));
+        findOccluders(*neighborhood, chunks.back().second);
+    }
+
+    const glm::vec3 surface = spawnPosition(world, generator, 0, 0) + glm::vec3(0.0f, PlayerBody::EYE_HEIGHT, 0.0f);
+    const glm::vec3 eyes[2] = { surface, surface - glm::vec3(0.0f, 24.0f, 0.0f) };
+    const char* const eyeNames[2] = { "surface", "underground" };
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+
+    SoftwareOcclusion occlusion;
+    for (int e = 0; e < 2; e++)
+        for (int yaw = 0; yaw < 360; yaw += 90)
+        {
+            const glm::vec3 front = lookDirection((float)yaw, -10.0f);
+            const glm::mat4 projectionView = projection * glm::lookAt(eyes[e], eyes[e] + front, glm::vec3(0.0f, 1.0f, 0.0f));
+            const Frustum frustum(projectionView);
+
+            occlusion.clear();
+            int inFrustum = 0;
+            for (const auto& chunk : chunks)
+            {
+                const OcclusionBox box{ glm::vec3(chunk.first * CHUNK_SIZE) - 0.5f, glm::vec3(chunk.first * CHUNK_SIZE) + (CHUNK_SIZE - 0.5f) };
+                if (!frustum.intersects(box.min, box.max))
+                    continue;
+                occlusion.addOccluders(chunk.second);
+                occlusion.addCandidate(chunk.first, box);
+                inFrustum++;
+            }
+            occlusion.begin(projectionView, eyes[e]);
+            occlusion.finish();
+
+            std::cout << "occlusion: " << eyeNames[e] << " yaw " << yaw << ", " << inFrustum << " chunks in the frustum, "
+                      << occlusion.hiddenCount() << " hidden by " << occlusion.occluderCount() << " occluders in "
+                      << occlusion.cost() << " ms" << std::endl;
+        }
+    return 0;
+}
+#endif
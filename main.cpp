@@ -14,6 +14,17 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include "shader.h"
+#include "world.h"
+#include "chunk_renderer.h"
+#include "frustum.h"
+#include "text_batch.h"
+#include "block_batch.h"
+#include "raycast.h"
+#include "physics.h"
+#include "simulation.h"
+#include "terrain.h"
+#include "headless.h"
+#include "chunk_streamer.h"
 #include "PerlinNoise.hpp"
 
 #include <iostream>
@@ -21,6 +32,9 @@
 #include <math.h>
 
 #include <map>
+#include <fstream>
+#include <sstream>
+#include <cstring>
 #include <filesystem>
 #include <windows.h>
 
@@ -28,90 +42,10 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
-unsigned int loadTexture(const char *path);
-glm::vec3 getRayFromMouse(double mouseX, double mouseY, glm::mat4 projectionMatrix, glm::mat4 viewMatrix);
-glm::vec3 getRayPlaneIntersection(glm::vec3 ray_origin, glm::vec3 ray_direction, glm::vec3 plane_normal, glm::vec3 plane_point);
-void mouse_button_callback(GLFWwindow* window, int button, int action, int mods, glm::mat4 projMatrix, glm::mat4 viewMatrix, Shader ourShader);
-void RenderText(Shader& shader, std::string text, float x, float y, float scale, glm::vec3 color);
-
-// Create a ray from the mouse cursor
-glm::vec3 CreateRay(GLFWwindow* window, glm::mat4 proj, glm::mat4 view)
-{
-    double xPos, yPos;
-    glfwGetCursorPos(window, &xPos, &yPos);
-
-    int width, height;
-    glfwGetWindowSize(window, &width, &height);
-
-    float mouseX = xPos / (width * 0.5f) - 1.0f;
-    float mouseY = yPos / (height * 0.5f) - 1.0f;
-
-    glm::mat4 invVP = glm::inverse(proj * view);
-    glm::vec4 screenPos = glm::vec4(mouseX, -mouseY, 1.0f, 1.0f);
-    glm::vec4 worldPos = invVP * screenPos;
-
-    glm::vec3 dir = glm::normalize(glm::vec3(worldPos));
-
-    return dir;
-}
-
-bool RayIntersectsObject(glm::vec3 rayStart, glm::vec3 rayDir, glm::vec3 objectPos, glm::vec3 objectSize, float maxDistance,
-    glm::vec3* hitNormal) {
-    // Calculate the minimum and maximum points of the object's bounding box
-    glm::vec3 min = objectPos - objectSize * 0.5f;
-    glm::vec3 max = objectPos + objectSize * 0.5f;
-
-    // Calculate the intersection points of the ray with each plane of the bounding box
-    float tmin = (min.x - rayStart.x) / rayDir.x;
-    float tmax = (max.x - rayStart.x) / rayDir.x;
-
-    if (tmin > tmax) std::swap(tmin, tmax);
-
-    float tymin = (min.y - rayStart.y) / rayDir.y;
-    float tymax = (max.y - rayStart.y) / rayDir.y;
-
-    if (tymin > tymax) std::swap(tymin, tymax);
-
-    if (tymin > tmin)
-        tmin = tymin;
-    if (tymax < tmax)
-        tmax = tymax;
+unsigned int loadTextureArray(const char* const* paths, int count);
 
-    if ((tmin > tmax))
-        return false;
-
-    float tzmin = (min.z - rayStart.z) / rayDir.z;
-    float tzmax = (max.z - rayStart.z) / rayDir.z;
-
-    if (tzmin > tzmax) std::swap(tzmin, tzmax);
-
-    if (tzmin > tmin)
-        tmin = tzmin;
-    if (tzmax < tmax)
-        tmax = tzmax;
-
-    if ((tmin > tmax))
-        return false;
-
-    // Calculate the intersection point
-    glm::vec3 intersectionPoint = rayStart + tmin * rayDir;
-
-    if (intersectionPoint.x == min.x) *hitNormal = glm::vec3(-1, 0, 0);
-    if (intersectionPoint.x == max.x) *hitNormal = glm::vec3(1, 0, 0);
-
-    if (intersectionPoint.y == min.y) *hitNormal = glm::vec3(0, -1, 0);
-    if (intersectionPoint.y == max.y) *hitNormal = glm::vec3(0, 1, 0);
-
-    if (intersectionPoint.z == min.z) *hitNormal = glm::vec3(0, 0, -1);
-    if (intersectionPoint.z == max.z) *hitNormal = glm::vec3(0, 0, 1);
-
-    // Check if the intersection point is within the maximum distance from the camera
-    float distance = glm::length(intersectionPoint - rayStart);
-    if (distance > maxDistance)
-        return false;
-
-    return true;
-}
+// how far away blocks can be placed and broken, in blocks
+const float PICK_REACH = 6.0f;
 
 
 
@@ -161,44 +95,6 @@ float vertices[] = {
     -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
 };
 
-
-// this doesnt work currently
-void tree(Shader shader, unsigned int wood_texture, unsigned int leaf_texture, unsigned int x, unsigned int y, unsigned int z)
-{
-    for (unsigned int height = y; height < y+3.0f; height++)
-    {
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, wood_texture);
-
-        glm::mat4 wood_model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        wood_model = glm::translate(wood_model, glm::vec3(x, height, z));
-        //float angle = 20.0f * i;
-        //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-        shader.setMat4("model", wood_model);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-    }
-
-
-    for (float z_new = z/2; z_new < z+3.0f; z_new++)
-    {
-        for (float x_new = x/2; x_new < x+3.0f; x_new++)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, leaf_texture);
-
-            glm::mat4 leaf_model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-            leaf_model = glm::translate(leaf_model, glm::vec3(x_new, y + 3.0f, z_new));
-            //float angle = 20.0f * i;
-            //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            shader.setMat4("model", leaf_model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
-}
-
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -214,73 +110,72 @@ float pitch = 0.0f;
 float lastX = 800.0f / 2.0;
 float lastY = 600.0 / 2.0;
 float fov = 45.0f;
-float cameraSpeed = 0.05f;
+float cameraSpeed = 4.3f; // walking speed in blocks per second
 
 // timing
 float deltaTime = 0.0f;	// time between current frame and last frame
 float lastFrame = 0.0f;
 
-bool canSpawnCube = true;
+World world;
+BlockID block_type = BLOCK_DIRT;
 
-bool blocks[30][10][30];
-unsigned int block_texture;
+// texture array with one layer per block material, see BLOCK_TEXTURE_PATHS
+unsigned int blockTextureArray;
 
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // Size of glyph
-    glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
-    unsigned int Advance;   // Horizontal offset to advance to next glyph
-};
-
-std::map<GLchar, Character> Characters;
+// glyph atlas of the HUD font, every line of text in a frame goes out in one draw call
+TextBatch textBatch;
+// the loose blocks of a frame, drawn instanced in one go
+BlockBatch blockBatch;
 
 struct Block {
     glm::vec3 position;
-    GLuint texture;
+    BlockID id;
 };
 
-// Constants
-const float GRAVITY = -9.8f;
-const float GROUND_Y = 10.0f;
+// the player and everything else that runs on the fixed tick, the camera sits at the player's eyes
+Simulation simulation;
+FixedTimestep timestep;
+// the same seed always gives the same world
+const unsigned int TERRAIN_SEED = 20240501;
 
-glm::vec3 cameraVel = glm::vec3(0.0f, 0.0f, 0.0f);
+// movement wanted by the keyboard, sampled in processInput and used by every tick of the frame
+PlayerInput playerInput;
 
-void simulatePhysics(float deltaTime, const std::vector<Block>& cubePositions)
-{
-    // Apply gravity to the camera
-    cameraVel.y += GRAVITY * deltaTime;
+unsigned int VBO, VAO;
 
-    // Update the camera position
-    glm::vec3 oldCameraPos = cameraPos;
-    cameraPos += cameraVel * deltaTime;
+// number of draw calls issued during the current frame
+unsigned int drawCalls = 0;
+// what frustum culling let through last frame, for the stats overlay
+CullStats chunkCulling;
+CullStats blockCulling;
 
-    // Check for collision with the ground
-    if (cameraPos.y < GROUND_Y)
-    {
-        // The camera has collided with the ground
-        // Set its position and velocity to zero
-        cameraPos.y = GROUND_Y;
-        cameraVel.y = 0.0f;
-    }
+int main(int argc, char* argv[])
+{
+    // --bench-terrain [radius]: measure terrain generation speed, see headless.h
+    if (argc > 1 && std::strcmp(argv[1], "--bench-terrain") == 0)
+        return runTerrainBenchmark(TERRAIN_SEED, argc > 2 ? std::atoi(argv[2]) : 8);
 
-    // Check for collision with each object
-    for (const auto& cube : cubePositions)
+    // --bench-occlusion [radius]: software occlusion culling from a few fixed views, see headless.h
+    if (argc > 1 && std::strcmp(argv[1], "--bench-occlusion") == 0)
+        return runOcclusionBenchmark(TERRAIN_SEED, argc > 2 ? std::atoi(argv[2]) : 8);
+
+    // --headless [script]: run the world without creating a window, see headless.h
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0)
     {
-        if (glm::distance(cameraPos, cube.position) < 1.0f)  // assuming objects are cubes with side length 1
+        if (argc > 2)
         {
-            // The camera has collided with an object
-            // Reset its position to the previous frame's position
-            cameraPos = oldCameraPos;
-            break;
+            std::ifstream script(argv[2]);
+            if (!script)
+            {
+                std::cout << "ERROR::HEADLESS: could not open script " << argv[2] << std::endl;
+                return -1;
+            }
+            return runHeadless(script, TERRAIN_SEED, PICK_REACH);
         }
+        std::istringstream script(HEADLESS_DEFAULT_SCRIPT);
+        return runHeadless(script, TERRAIN_SEED, PICK_REACH);
     }
-}
-
-unsigned int VBO, VAO, textVBO, textVAO;
 
-int main()
-{
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -327,7 +222,8 @@ int main()
     Shader shader("text.vert", "text.frag");
     glm::mat4 textProjection = glm::ortho(0.0f, static_cast<float>(SCR_WIDTH), 0.0f, static_cast<float>(SCR_HEIGHT));
     shader.use();
-    glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(textProjection));
+    shader.setMat4("projection", textProjection);
+    shader.setInt("text", 0);
 
         // FreeType
     // --------
@@ -348,11 +244,8 @@ int main()
         // set size to load glyphs as
         FT_Set_Pixel_Sizes(face, 0, 48);
 
-        // disable byte-alignment restriction
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-        // load first 128 characters of ASCII set
-        for (unsigned char c = 0; c < 128; c++)
+        // load first 128 characters of ASCII set into the glyph atlas
+        for (unsigned char c = 0; c < TextBatch::GLYPH_COUNT; c++)
         {
             // Load character glyph 
             if (FT_Load_Char(face, c, FT_LOAD_RENDER))
@@ -360,54 +253,23 @@ int main()
                 std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
                 continue;
             }
-            // generate texture
-            unsigned int TXTRE;
-            glGenTextures(1, &TXTRE);
-            glBindTexture(GL_TEXTURE_2D, TXTRE);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            // now store character for later use
-            Character character = {
-                TXTRE,
-                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                static_cast<unsigned int>(face->glyph->advance.x)
-            };
-            Characters.insert(std::pair<char, Character>(c, character));
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            textBatch.addGlyph(c, bitmap.width, bitmap.rows, bitmap.pitch, bitmap.buffer,
+                face->glyph->bitmap_left, face->glyph->bitmap_top,
+                static_cast<unsigned int>(face->glyph->advance.x));
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
     }
     // destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
 
-    glGenVertexArrays(1, &textVAO);
-    glGenBuffers(1, &textVBO);
-    glBindVertexArray(textVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    textBatch.uploadAtlas();
 
     // build and compile our shader zprogram
     // ------------------------------------
-    Shader ourShader("shader.vert", "shader.frag");
+    Shader ourShader("cube.vert", "shader.frag");
+    // chunk meshes use packed vertices, decoded in shader.vert
+    Shader chunkShader("shader.vert", "shader.frag");
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -423,41 +285,43 @@ int main()
     // texture coord attribute
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+    // the instanced blocks read the same cube vertices
+    blockBatch.create(VBO);
 
 
     // load and create a texture 
     // -------------------------
 
-    unsigned int grasstexture = loadTexture("textures\\grassblock.jpg");
-    unsigned int dirttexture = loadTexture("textures\\dirtblock.jpg");
-    unsigned int stonetexture = loadTexture("textures\\stoneblock.jpg");
-    unsigned int diamondtexture = loadTexture("textures\\diamondblock.jpg");
-    unsigned int coaltexture = loadTexture("textures\\coalblock.jpg");
-    unsigned int irontexture = loadTexture("textures\\ironblock.jpg");
-    unsigned int watertexture = loadTexture("textures\\waterblock.jpg");
-    unsigned int leaftexture = loadTexture("textures\\leafblock.jpg");
-    unsigned int woodtexture = loadTexture("textures\\woodblock.jpg");
-    unsigned int bedrocktexture = loadTexture("textures\\bedrockblock.jpg");
-    unsigned int planktexture = loadTexture("textures\\plankblock.jpg");
-    unsigned int bricktexture = loadTexture("textures\\brickblock.jpg");
-    unsigned int oaktexture = loadTexture("textures\\oakblock.jpg");
-    unsigned int glasstexture = loadTexture("textures\\glassblock.jpg");
+    // every block material is one layer of a single texture array, so drawing never has to switch textures
+    blockTextureArray = loadTextureArray(BLOCK_TEXTURE_PATHS + 1, BLOCK_COUNT - 1);
 
     // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
     // -------------------------------------------------------------------------------------------
     ourShader.use();
-    ourShader.setInt("texture1", 0);
-    //ourShader.setInt("texture2", 1);
+    ourShader.setInt("blockTextures", 0);
+    chunkShader.use();
+    chunkShader.setInt("blockTextures", 0);
+    chunkShader.setInt("chunkOrigins", 1);
+
+    // uniforms set every frame, looked up once
+    const Shader::Uniform cubeProjection = ourShader.uniform("projection");
+    const Shader::Uniform cubeView = ourShader.uniform("view");
+    const Shader::Uniform chunkProjection = chunkShader.uniform("projection");
+    const Shader::Uniform chunkView = chunkShader.uniform("view");
+
+    // the loose blocks floating above the world
+    std::vector<Block> showcaseBlocks = {
+        { glm::vec3(5.0f, 0.0f, 5.0f), BLOCK_DIAMOND },
+        { glm::vec3(7.0f, 0.0f, 5.0f), BLOCK_IRON },
+        { glm::vec3(9.0f, 0.0f, 5.0f), BLOCK_COAL },
+        { glm::vec3(11.0f, 0.0f, 5.0f), BLOCK_WATER }
+    };
 
     /*float distance = 5.0f;
     glm::vec3 cubePos = cameraPos + cameraFront + distance;
     std::vector<glm::vec3> cubePositions;
     cubePositions.push_back(cubePos);*/
 
-    float distance = 5.0f;
-    glm::vec3 cubePos = cameraPos + cameraFront + distance;
-    std::vector<Block> cubePositions;
-
     double prevTime = 0.0;
     double crntTime = 0.0;
     double timeDiff;
@@ -468,17 +332,22 @@ int main()
     // uncomment the line below this text to draw everything in wireframe polygons
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-    // Initialize the blocks array
-    for (unsigned int x = 0; x < 30; x++)
-    {
-        for (unsigned int y = 0; y < 10; y++)
-        {
-            for (unsigned int z = 0; z < 30; z++)
-            {
-                blocks[x][y][z] = true;
-            }
-        }
-    }
+    // Initialize the world: build the terrain around the origin on every core, from then on the
+    // streamer keeps it generated around the player
+    TerrainGenerator terrain(TERRAIN_SEED);
+    ChunkStreamer streamer(terrain);
+    streamer.fill(world, glm::vec3(0.0f));
+    std::vector<glm::ivec3> unloadedChunks;
+    // the showcase blocks float a few blocks above the ground below them
+    for (Block& block : showcaseBlocks)
+        block.position.y = terrain.surfaceHeight((int)block.position.x, (int)block.position.z) + 3.0f;
+
+    // drop the player in above the middle of the world
+    simulation.reset(spawnPosition(world, terrain, 0, 0));
+    cameraPos = simulation.interpolatedEye(0.0f);
+
+    ChunkRenderer chunkRenderer;
+    chunkRenderer.create((GLADloadproc)glfwGetProcAddress);
 
     // Keep track of the time when the last block was spawned
     double lastBlockSpawnTime = 0.0;
@@ -498,13 +367,20 @@ int main()
 
         //simulatePhysics(.5);
 
-        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) block_texture = dirttexture;
-        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) block_texture = grasstexture;
-        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) block_texture = stonetexture;
-        if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) block_texture = planktexture;
-        if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS) block_texture = bricktexture;
-        if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS) block_texture = oaktexture;
-        if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS) block_texture = glasstexture;
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) block_type = BLOCK_DIRT;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) block_type = BLOCK_GRASS;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) block_type = BLOCK_STONE;
+        if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) block_type = BLOCK_PLANK;
+        if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS) block_type = BLOCK_BRICK;
+        if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS) block_type = BLOCK_OAK;
+        if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS) block_type = BLOCK_GLASS;
+
+        // G switches to the greedy mesher, N back to one quad per block face
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS) chunkRenderer.setMeshMode(world, MESH_GREEDY);
+        if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS) chunkRenderer.setMeshMode(world, MESH_NAIVE);
+        // O culls hidden chunks with gpu occlusion queries, P with the software occlusion worker
+        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS) chunkRenderer.setOcclusionMode(OCCLUSION_QUERIES);
+        if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) chunkRenderer.setOcclusionMode(OCCLUSION_SOFTWARE);
 
         crntTime = glfwGetTime();
         timeDiff = crntTime - prevTime;
@@ -513,11 +389,15 @@ int main()
         {
             std::string FPS = std::to_string((1.0 / timeDiff) * counter);
             std::string ms = std::to_string((timeDiff / counter) * 1000);
-            std::string newTitle = "Minecraft - " + FPS + "FPS / " + ms + "ms";
+            std::string meshMode = chunkRenderer.getMeshMode() == MESH_GREEDY ? " (greedy" : " (naive";
+            meshMode += chunkRenderer.usesIndirectDraw() ? ", indirect)" : ", multi draw)";
+            std::string newTitle = "Minecraft - " + FPS + "FPS / " + ms + "ms / " + std::to_string(drawCalls) + " draw calls / "
+                + std::to_string(chunkRenderer.vertexCount()) + " vertices / " + std::to_string(streamer.loadedColumns()) + " columns" + meshMode;
             glfwSetWindowTitle(window, newTitle.c_str());
             prevTime = crntTime;
             counter = 0;
         }
+        drawCalls = 0;
 
         // per-frame time logic
         // --------------------
@@ -529,6 +409,12 @@ int main()
         // -----
         processInput(window);
 
+        // run the simulation at its fixed rate, then place the camera between the last two ticks
+        int ticks = timestep.advance(deltaTime);
+        for (int i = 0; i < ticks; i++)
+            simulation.tick(world, playerInput);
+        cameraPos = simulation.interpolatedEye(timestep.alpha());
+
         // render
         // ------
 
@@ -537,13 +423,26 @@ int main()
         glClearColor(61.0f / 255.0f, 174.0f / 255.0f, 255.0f / 255.0f, 1.0f); // this is background text
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        RenderText(shader, "press 1 to change material to dirt", 470.0f, 570.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
-        RenderText(shader, "press 2 to change material to grass", 470.0f, 550.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
-        RenderText(shader, "press 3 to change material to stone", 470.0f, 530.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
-        RenderText(shader, "press 4 to change material to wood", 470.0f, 510.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
-        RenderText(shader, "press 5 to change material to wall", 470.0f, 490.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
-        RenderText(shader, "press 6 to change material to wood", 470.0f, 470.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
-        RenderText(shader, "press 7 to change material to glass", 470.0f, 450.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 1 to change material to dirt", 470.0f, 570.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 2 to change material to grass", 470.0f, 550.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 3 to change material to stone", 470.0f, 530.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 4 to change material to wood", 470.0f, 510.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 5 to change material to wall", 470.0f, 490.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 6 to change material to wood", 470.0f, 470.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        textBatch.add("press 7 to change material to glass", 470.0f, 450.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        std::string cullingStats = "chunks " + std::to_string(chunkCulling.visible) + " visible / " + std::to_string(chunkCulling.culled)
+            + " culled / " + std::to_string(chunkCulling.occluded) + " occluded, blocks " + std::to_string(blockCulling.visible) + " / " + std::to_string(blockCulling.culled);
+        textBatch.add(cullingStats, 10.0f, 570.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        if (chunkRenderer.getOcclusionMode() == OCCLUSION_SOFTWARE)
+        {
+            const SoftwareOcclusion& occlusion = chunkRenderer.getSoftwareOcclusion();
+            std::string occlusionStats = "software occlusion: " + std::to_string(occlusion.occluderCount()) + " occluders, "
+                + std::to_string(occlusion.cost()) + " ms";
+            textBatch.add(occlusionStats, 10.0f, 550.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        }
+        else
+            textBatch.add("occlusion queries (press p for software occlusion)", 10.0f, 550.0f, 0.5f, glm::vec3(255.0f, 0.0f, 0.0f));
+        drawCalls += textBatch.flush(shader);
 
         // bind textures on corresponding texture units
         //glActiveTexture(GL_TEXTURE1);
@@ -554,157 +453,35 @@ int main()
 
         // pass projection matrix to shader (note that in this case it could change every frame)
         glm::mat4 objectProjection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        ourShader.setMat4("projection", objectProjection);
+        ourShader.setMat4(cubeProjection, objectProjection);
 
         // camera/view transformation
         glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-        ourShader.setMat4("view", view);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diamondtexture);
-
-        glm::mat4 diamond_model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        diamond_model = glm::translate(diamond_model, glm::vec3(5.0f, 15.0f, 5.0f));
-        //float angle = 20.0f * i;
-        //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-        ourShader.setMat4("model", diamond_model);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, irontexture);
-
-        glm::mat4 iron_model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        iron_model = glm::translate(iron_model, glm::vec3(7.0f, 15.0f, 5.0f));
-        //float angle = 20.0f * i;
-        //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-        ourShader.setMat4("model", iron_model);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        ourShader.setMat4(cubeView, view);
 
+        // everything outside the view volume is skipped before it costs a draw call
+        const Frustum frustum(objectProjection * view);
+        chunkCulling = CullStats();
+        blockCulling = CullStats();
+        // software occlusion runs on its worker until the chunks are drawn
+        chunkRenderer.beginOcclusion(frustum, objectProjection * view, cameraPos);
 
+        // the block texture array is bound once for everything drawn this frame
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, coaltexture);
-
-        glm::mat4 coal_model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        coal_model = glm::translate(coal_model, glm::vec3(9.0f, 15.0f, 5.0f));
-        //float angle = 20.0f * i;
-        //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-        ourShader.setMat4("model", coal_model);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, watertexture);
-
-        glm::mat4 water_model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        water_model = glm::translate(water_model, glm::vec3(11.0f, 15.0f, 5.0f));
-        //float angle = 20.0f * i;
-        //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-        ourShader.setMat4("model", water_model);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, blockTextureArray);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        //tree(ourShader, woodtexture, leaftexture, 10, 0, 10);
-
-/*// Check if the left mouse button was pressed
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
+        for (const Block& block : showcaseBlocks)
         {
-            // Left mouse button was pressed
-            glm::vec3 rayDir = CreateRay(window, projection, view);
-
-            // Check if the ray intersects with any objects
-            for (unsigned int x = 0; x < 30; x++)
+            if (!frustum.intersects(block.position - 0.5f, block.position + 0.5f))
             {
-                for (unsigned int y = 0; y < 10; y++)
-                {
-                    for (unsigned int z = 0; z < 30; z++)
-                    {
-                        bool intersects = RayIntersectsObject(cameraPos, rayDir, glm::vec3(x, y, z), glm::vec3(1.0f, 1.0f, 1.0f), 1.0f);
-
-                        if (intersects && canSpawnCube)
-                        {
-                            // The ray intersects with the object
-                            // Place a new block on top of the intersected block
-                            cubePositions.push_back(glm::vec3(x, y + 1, z));
-                            canSpawnCube = false;
-                        }
-                    }
-                }
-            }
-
-            // Check if the ray intersects with any previously spawned cubes
-            for (const auto& cubePos : cubePositions)
-            {
-                bool intersects = RayIntersectsObject(cameraPos, rayDir, cubePos, glm::vec3(1.0f, 1.0f, 1.0f), 1.0f);
-
-                if (intersects && canSpawnCube)
-                {
-                    // The ray intersects with the previously spawned cube
-                    // Place a new block on top of the intersected block
-                    cubePositions.push_back(cubePos + glm::vec3(0.0f, 1, 0.0f));
-                    canSpawnCube = false;
-                }
+                blockCulling.culled++;
+                continue;
             }
-
-            canSpawnCube = true;
+            blockCulling.visible++;
+            blockBatch.add(block.position, block.id);
         }
+        drawCalls += blockBatch.flush(ourShader);
 
-        glBindVertexArray(VAO);
-        for (const auto& cubePos : cubePositions)
-        {
-
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePos);
-            ourShader.setMat4("model", model);
-
-            // add code to check if a cube is touching another cube then delete the insides we cant see........
-            //if(cubePos.x+cubePos.)
-
-            // code to draw cube
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-
-
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
-        {
-            // Right mouse button was pressed
-            glm::vec3 rayDir = CreateRay(window, projection, view);
-
-            // Check if the ray intersects with any objects
-            bool cubeDeleted = false;
-            for (unsigned int x = 0; x < 30 && !cubeDeleted; x++)
-            {
-                for (unsigned int y = 0; y < 10 && !cubeDeleted; y++)
-                {
-                    for (unsigned int z = 0; z < 30 && !cubeDeleted; z++)
-                    {
-                        bool intersects = RayIntersectsObject(cameraPos, rayDir, glm::vec3(x, y, z), glm::vec3(1.0f, 1.0f, 1.0f), 1.0f);
-
-                        if (intersects) {
-                            // The ray intersects with the object
-                            // Remove the object from the scene
-                            blocks[x][y][z] = false;
-                            cubeDeleted = true;
-                        }
-                    }
-                }
-            }
-
-            // Check if the ray intersects with any previously spawned cubes
-            for (auto it = cubePositions.begin(); it != cubePositions.end() && !cubeDeleted; ++it)
-            {
-                bool intersects = RayIntersectsObject(cameraPos, rayDir, *it, glm::vec3(1.0f, 1.0f, 1.0f), 1.0f);
-
-                if (intersects)
-                {
-                    // The ray intersects with the previously spawned cube
-                    // Remove the cube from the scene
-                    cubePositions.erase(it);
-                    cubeDeleted = true;
-                }
-            }
-        }*/
         // Calculate deltaTime
         /*float currentFrame2 = glfwGetTime();
         float deltaTime = currentFrame2 - lastFrame;
@@ -719,245 +496,51 @@ int main()
             if (currentTime - lastBlockSpawnTime >= blockSpawnDelay)
             {
                 // Enough time has passed since the last block spawn
-                glm::vec3 rayDir = CreateRay(window, objectProjection, view);
+                // the cursor is captured, so blocks are picked along the view direction
+                glm::vec3 rayDir = glm::normalize(cameraFront);
 
-                // Check if the ray intersects with any objects
-                bool blockSpawned = false;
-                for (unsigned int x = 0; x < 30 && !blockSpawned; x++)
-                {
-                    for (unsigned int y = 0; y < 10 && !blockSpawned; y++)
-                    {
-                        for (unsigned int z = 0; z < 30 && !blockSpawned; z++)
-                        {
-                            glm::vec3 hitNormal;
-                            bool intersects = RayIntersectsObject(cameraPos, rayDir, glm::vec3(x, y, z), glm::vec3(1.0f, 1.0f, 1.0f), 0.10f, &hitNormal);
-                            if (intersects) {
-                                // The ray intersects with the object
-                                // Place a new block on the side of the intersected block
-                                Block newBlock;
-                                newBlock.position = glm::vec3(x, y, z) + hitNormal;
-                                newBlock.texture = block_texture;
-                                cubePositions.push_back(newBlock);
-                                lastBlockSpawnTime = currentTime;
-                                blockSpawned = true;
-                            }
-                        }
-                    }
-                }
-                // Check if the ray intersects with any previously spawned cubes
-                std::vector<Block> cubePositionsCopy = cubePositions;
-                for (const auto& cube : cubePositionsCopy)
+                // Walk the blocks along the ray until the first solid one
+                RaycastHit hit;
+                if (raycastBlocks(world, cameraPos, rayDir, PICK_REACH, &hit))
                 {
-                    glm::vec3 hitNormal;
-                    bool intersects = RayIntersectsObject(cameraPos, rayDir, cube.position, glm::vec3(1.0f, 1.0f, 1.0f), 0.10f, &hitNormal);
-                    if (intersects && canSpawnCube)
+                    // Place a new block in the empty cell in front of the face that was hit
+                    if (!world.isSolidAt(hit.previous) && !overlapsBlock(simulation.player.bounds(), hit.previous))
                     {
-                        // The ray intersects with the previously spawned cube
-                        // Place a new block on the side of the intersected block
-                        Block newBlock;
-                        newBlock.position = cube.position + hitNormal;
-                        newBlock.texture = block_texture;
-                        cubePositions.push_back(newBlock);
-                        canSpawnCube = false;
-                        blockSpawned = true;
+                        world.setBlock(hit.previous, block_type);
+                        lastBlockSpawnTime = currentTime;
                     }
                 }
-                canSpawnCube = true;
             }
         }
 
-
-        glBindVertexArray(VAO);
-        for (const auto& cube : cubePositions)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, cube.texture);
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cube.position);
-            ourShader.setMat4("model", model);
-            // code to draw cube
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-
-
-        /*glBindVertexArray(VAO);
-        for (const auto& cube : cubePositions)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, cube.texture);
-
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cube.position);
-            ourShader.setMat4("model", model);
-
-            // code to draw cube
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }*/
-
-
         if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
         {
             // Right mouse button was pressed
-            glm::vec3 rayDir = CreateRay(window, objectProjection, view);
-
-            // Check if the ray intersects with any objects
-            bool cubeDeleted = false;
-            for (unsigned int x = 0; x < 30 && !cubeDeleted; x++)
-            {
-                for (unsigned int y = 0; y < 10 && !cubeDeleted; y++)
-                {
-                    for (unsigned int z = 0; z < 30 && !cubeDeleted; z++)
-                    {
-                        glm::vec3 hitNormal;
-                        bool intersects = RayIntersectsObject(cameraPos, rayDir, glm::vec3(x, y, z), glm::vec3(1.0f, 1.0f, 1.0f), 0.25f, &hitNormal);
-                        if (intersects) {
-                            // The ray intersects with the object
-                            // Remove the object from the scene
-                            blocks[x][y][z] = false;
-                            cubeDeleted = true;
-                        }
-                    }
-                }
-            }
-
-            // Check if the ray intersects with any previously spawned cubes
-            for (auto it = cubePositions.begin(); it != cubePositions.end() && !cubeDeleted; ++it)
-            {
-                glm::vec3 hitNormal;
-                bool intersects = RayIntersectsObject(cameraPos, rayDir, it->position, glm::vec3(1.0f, 1.0f, 1.0f), 0.25f, &hitNormal);
-                if (intersects)
-                {
-                    // The ray intersects with the previously spawned cube
-                    // Remove the cube from the scene
-                    it->position -= hitNormal;
-                    it = cubePositions.erase(it);
-                    cubeDeleted = true;
-                }
-            }
-        }
-
+            // the cursor is captured, so blocks are picked along the view direction
+            glm::vec3 rayDir = glm::normalize(cameraFront);
 
-        // render boxes
-        glBindVertexArray(VAO);
-        for (unsigned int x = 0; x < 30; x++)
-        {
-            for (unsigned int y = 0; y < 10; y++)
+            // Walk the blocks along the ray until the first solid one
+            RaycastHit hit;
+            if (raycastBlocks(world, cameraPos, rayDir, PICK_REACH, &hit))
             {
-                for (unsigned int z = 0; z < 30; z++)
-                {
-                    if (!blocks[x][y][z]) continue;
-
-                    // loading textures
-                    if (y > 7)
-                    {
-                        glActiveTexture(GL_TEXTURE0);
-                        glBindTexture(GL_TEXTURE_2D, grasstexture);
-                    }
-                    else if (y < 7 && y > 5)
-                    {
-                        glActiveTexture(GL_TEXTURE0);
-                        glBindTexture(GL_TEXTURE_2D, dirttexture);
-                    }
-                    else if (y < 5)
-                    {
-                        glActiveTexture(GL_TEXTURE0);
-                        glBindTexture(GL_TEXTURE_2D, stonetexture);
-                    }
-
-                    // calculate the model matrix for each object and pass it to shader before drawing
-                    glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-                    model = glm::translate(model, glm::vec3(x, y, z));
-                    
-                    model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-                    //float angle = 20.0f * i;
-                    //model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-                    ourShader.setMat4("model", model);
-                    
-                    // one face has 6 triangles, 6 faces = 36 triangles
-                    // check neighboring cubes
-                    bool left = x > 0;
-                    bool right = x < 29;
-                    bool bottom = y > 0;
-                    bool top = y < 9;
-                    bool front = z > 0;
-                    bool back = z < 29;  
-
-                    // draw only visible faces
-                    if (!left) glDrawArrays(GL_TRIANGLES, 0, 6); // left face
-                    if (!right) glDrawArrays(GL_TRIANGLES, 6, 6); // right face
-                    if (!bottom) glDrawArrays(GL_TRIANGLES, 12, 6); // bottom face
-                    if (!top) glDrawArrays(GL_TRIANGLES, 18, 6); // top face
-                    if (!front) glDrawArrays(GL_TRIANGLES, 24, 6); // front face
-                    if (!back) glDrawArrays(GL_TRIANGLES, 30, 6); // back face
-
-                    // Create a ray from the mouse cursor
-                    /*glm::vec3 rayDir = CreateRay(window, projection, view);
-
-                    bool intersects = RayIntersectsObject(cameraPos, rayDir, glm::vec3(x, y, z), glm::vec3(1.0f, 1.0f, 1.0f));
-
-                    if (intersects) {
-                        // The ray intersects with the object
-                        `// ...  
-                        //std::cout << "intersect\n";
-                    }
-                    else {
-                        // The ray does not intersect with the object
-                        // ...
-                    }*/
-                }
+                // Remove the block from the world
+                world.setBlock(hit.block, BLOCK_AIR);
             }
         }
 
-        /*if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
-        {
-            if (canSpawnCube)
-            {
-                double xpos, ypos;
-                glfwGetCursorPos(window, &xpos, &ypos);
-
-                int width, height;
-                glfwGetWindowSize(window, &width, &height);
-
-                float z;
-                glReadPixels(xpos, height - ypos - 1, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &z);
-
-                glm::mat4 model = glm::mat4(1.0f);
-                glm::vec4 viewport = glm::vec4(0.0f, 0.0f, (float)width, (float)height);
-                glm::vec3 screenPos = glm::vec3(xpos, height - ypos - 1, z);
-                glm::vec3 worldPos = glm::unProject(screenPos, view * model, projection, viewport);
-
-                std::cout << "Model: " << glm::to_string(model) << "\n";
-                std::cout << "Viewport: " << glm::to_string(viewport) << "\n";
-                std::cout << "ScreenPosition: " << glm::to_string(screenPos) << "\n";
-                std::cout << "WorldPosition: " << glm::to_string(worldPos) << "\n";
-
-                
-
-                // Add the new cube position to the vector
-                //cubePositions.push_back(worldPos);
-
-                canSpawnCube = false;
-            }
-        }
-        else
-        {
-            canSpawnCube = true;
-        }
-                // Render all cubes
-        glBindVertexArray(VAO);
-        for (const auto& cubePos : cubePositions)
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePos);
-            ourShader.setMat4("model", model);
 
-            // add code to check if a cube is touching another cube then delete the insides we cant see........
-            //if(cubePos.x+cubePos.)
+        // stream the world around the player, the meshes of dropped chunks go with them
+        unloadedChunks.clear();
+        streamer.update(world, cameraPos, cameraFront, unloadedChunks);
+        for (const glm::ivec3& coord : unloadedChunks)
+            chunkRenderer.release(coord);
 
-            // code to draw cube
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }*/
+        // render chunks: rebuild the meshes of changed chunks, then all visible ones in one multi draw from the vertex arena
+        chunkRenderer.update(world);
+        chunkShader.use();
+        chunkShader.setMat4(chunkProjection, objectProjection);
+        chunkShader.setMat4(chunkView, view);
+        drawCalls += chunkRenderer.draw(chunkShader, frustum, cameraPos, chunkCulling);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -969,6 +552,9 @@ int main()
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    chunkRenderer.destroy();
+    textBatch.destroy();
+    blockBatch.destroy();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -976,50 +562,35 @@ int main()
     return 0;
 }
 
-glm::vec3 getRayFromMouse(double mouseX, double mouseY, glm::mat4 projectionMatrix, glm::mat4 viewMatrix)
-{
-    float x = (2.0f * mouseX) / SCR_WIDTH - 1.0f;
-    float y = 1.0f - (2.0f * mouseY) / SCR_HEIGHT;
-    float z = 1.0f;
-    glm::vec3 ray_nds = glm::vec3(x, y, z);
-    glm::vec4 ray_clip = glm::vec4(ray_nds.x, ray_nds.y, -1.0, 1.0);
-    glm::vec4 ray_eye = glm::inverse(projectionMatrix) * ray_clip;
-    ray_eye = glm::vec4(ray_eye.x, ray_eye.y, -1.0, 0.0);
-    glm::vec3 ray_wor = (glm::inverse(viewMatrix) * ray_eye);
-    ray_wor = glm::normalize(ray_wor);
-    return ray_wor;
-}
-
-glm::vec3 getRayPlaneIntersection(glm::vec3 ray_origin, glm::vec3 ray_direction, glm::vec3 plane_normal, glm::vec3 plane_point)
-{
-    float d = glm::dot((plane_point - ray_origin), plane_normal) / glm::dot(ray_direction, plane_normal);
-    return ray_origin + d * ray_direction;
-}
-
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow* window)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+    // walk along the ground in the direction the camera looks, the physics moves the player
+    glm::vec3 forward = glm::vec3(cameraFront.x, 0.0f, cameraFront.z);
+    forward = glm::length(forward) > 0.0f ? glm::normalize(forward) : glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 right = glm::normalize(glm::cross(forward, cameraUp));
+    glm::vec3 direction = glm::vec3(0.0f);
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        cameraPos += cameraSpeed * cameraFront;
+        direction += forward;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        cameraPos -= cameraSpeed * cameraFront;
+        direction -= forward;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+        direction -= right;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-        cameraPos.y += 1.0f;
+        direction += right;
+    playerInput.jump = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
     if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
     {
-        cameraSpeed = 0.20f;
+        cameraSpeed = 6.0f;
     }
     if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_RELEASE)
     {
-        cameraSpeed = 0.05f;
+        cameraSpeed = 4.3f;
     }
+    playerInput.walkVelocity = glm::length(direction) > 0.0f ? glm::normalize(direction) * cameraSpeed : glm::vec3(0.0f);
     if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS)
     {
         // enabling wireframe mode
@@ -1091,86 +662,38 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
         fov = 45.0f;
 }
 
-unsigned int loadTexture(const char *path)
+// load equally sized images into the layers of one GL_TEXTURE_2D_ARRAY
+// ---------------------------------------------------------------------
+unsigned int loadTextureArray(const char* const* paths, int count)
 {
+    const int size = 512; // every block texture has to be 512x512
+
     unsigned int textureID;
     glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, size, size, count, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
+    for (int layer = 0; layer < count; layer++)
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
+        int width, height, nrComponents;
+        // always ask for 4 channels so every layer has the same format
+        unsigned char* data = stbi_load(paths[layer], &width, &height, &nrComponents, 4);
+        if (data && width == size && height == size)
+        {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+        else
+        {
+            std::cout << "Texture failed to load at path: " << paths[layer] << " (must be " << size << "x" << size << ")" << std::endl;
+        }
         stbi_image_free(data);
     }
 
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
     return textureID;
 }
-
-// render line of text
-// -------------------
-void RenderText(Shader& shader, std::string text, float x, float y, float scale, glm::vec3 color)
-{
-    // activate corresponding render state	
-    shader.use();
-    glUniform4f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z, 0.5f);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(textVAO);
-
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
-    {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float textVertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(textVertices), textVertices); // be sure to use glBufferSubData and not glBufferData
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
-    }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
\ No newline at end of file
@@ -0,0 +1,297 @@
+#ifndef MESHER_H
+#define MESHER_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "world.h"
+
+// faces of a block, in the order of the normals below
+enum Face
+{
+    FACE_LEFT = 0, // -x
+    FACE_RIGHT,    // +x
+    FACE_BOTTOM,   // -y
+    FACE_TOP,      // +y
+    FACE_BACK,     // -z
+    FACE_FRONT,    // +z
+    FACE_COUNT
+};
+
+const glm::ivec3 FACE_NORMALS[FACE_COUNT] = {
+    glm::ivec3(-1, 0, 0), glm::ivec3(1, 0, 0),
+    glm::ivec3(0, -1, 0), glm::ivec3(0, 1, 0),
+    glm::ivec3(0, 0, -1), glm::ivec3(0, 0, 1)
+};
+
+// corners of every face relative to the block center, counter-clockwise seen from outside
+const float FACE_CORNERS[FACE_COUNT][4][3] = {
+    { { -0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f,  0.5f }, { -0.5f,  0.5f,  0.5f }, { -0.5f,  0.5f, -0.5f } },
+    { {  0.5f, -0.5f,  0.5f }, {  0.5f, -0.5f, -0.5f }, {  0.5f,  0.5f, -0.5f }, {  0.5f,  0.5f,  0.5f } },
+    { { -0.5f, -0.5f, -0.5f }, {  0.5f, -0.5f, -0.5f }, {  0.5f, -0.5f,  0.5f }, { -0.5f, -0.5f,  0.5f } },
+    { { -0.5f,  0.5f,  0.5f }, {  0.5f,  0.5f,  0.5f }, {  0.5f,  0.5f, -0.5f }, { -0.5f,  0.5f, -0.5f } },
+    { {  0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, -0.5f }, { -0.5f,  0.5f, -0.5f }, {  0.5f,  0.5f, -0.5f } },
+    { { -0.5f, -0.5f,  0.5f }, {  0.5f, -0.5f,  0.5f }, {  0.5f,  0.5f,  0.5f }, { -0.5f,  0.5f,  0.5f } }
+};
+
+// two triangles per face, the second set splits the quad along the other diagonal
+const int QUAD_INDICES[6] = { 0, 1, 2, 2, 3, 0 };
+const int QUAD_INDICES_FLIPPED[6] = { 1, 2, 3, 3, 0, 1 };
+
+// chunk vertices are packed into a single 32-bit integer, decoded again in shader.vert:
+//   bits  0-14  corner position inside the chunk, 5 bits per axis (0..CHUNK_SIZE)
+//   bits 15-17  face index (see Face), the shader derives normal and texture coordinates from it
+//   bits 18-19  ambient occlusion of the corner, 0 (darkest) to 3 (unoccluded)
+//   bits 20-27  layer of the block texture array
+typedef std::uint32_t PackedVertex;
+
+inline PackedVertex packVertex(int x, int y, int z, int face, int ao, BlockID id)
+{
+    return (PackedVertex)x | ((PackedVertex)y << 5) | ((PackedVertex)z << 10)
+        | ((PackedVertex)face << 15) | ((PackedVertex)ao << 18) | ((PackedVertex)textureLayer(id) << 20);
+}
+
+// cpu side mesh of a single chunk, ready to be uploaded. every vertex carries its own texture
+// layer, so the whole chunk is drawn at once no matter how many materials it contains
+struct ChunkMeshData
+{
+    std::vector<PackedVertex> vertices;
+
+    int vertexCount() const
+    {
+        return (int)vertices.size();
+    }
+};
+
+// emit a quad covering size blocks (size is 1 along the face normal) starting at the chunk local
+// block minBlock, ao holds the occlusion of the four face corners in FACE_CORNERS order
+inline void emitQuad(std::vector<PackedVertex>& vertices, const glm::ivec3& minBlock, const glm::ivec3& size, int face, BlockID id, const int* ao)
+{
+    // split along the diagonal with the smaller occlusion difference so the shading stays symmetric
+    const int* indices = ao[0] + ao[2] < ao[1] + ao[3] ? QUAD_INDICES_FLIPPED : QUAD_INDICES;
+    for (int i = 0; i < 6; i++)
+    {
+        const float* corner = FACE_CORNERS[face][indices[i]];
+        int p[3];
+        for (int a = 0; a < 3; a++)
+            p[a] = minBlock[a] + (corner[a] < 0.0f ? 0 : size[a]);
+        vertices.push_back(packVertex(p[0], p[1], p[2], face, ao[indices[i]], id));
+    }
+}
+
+// copy of a chunk plus a one block border taken from its neighbours, so face culling
+// can look across chunk borders without touching the world
+// ------------------------------------------------------------------------
+const int PADDED_SIZE = CHUNK_SIZE + 2;
+const int PADDED_VOLUME = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+
+struct ChunkNeighborhood
+{
+    glm::ivec3 coord;
+    BlockID blocks[PADDED_VOLUME];
+
+    // x, y and z go from -1 to CHUNK_SIZE
+    static int index(int x, int y, int z)
+    {
+        return ((y + 1) * PADDED_SIZE + (z + 1)) * PADDED_SIZE + (x + 1);
+    }
+
+    BlockID get(int x, int y, int z) const
+    {
+        return blocks[index(x, y, z)];
+    }
+};
+
+inline void gatherNeighborhood(const World& world, const glm::ivec3& coord, ChunkNeighborhood& neighborhood)
+{
+    // look up the 27 chunks once instead of once per block
+    const Chunk* around[3][3][3];
+    for (int dy = -1; dy <= 1; dy++)
+        for (int dz = -1; dz <= 1; dz++)
+            for (int dx = -1; dx <= 1; dx++)
+                around[dy + 1][dz + 1][dx + 1] = world.getChunk(coord + glm::ivec3(dx, dy, dz));
+
+    neighborhood.coord = coord;
+    for (int y = -1; y <= CHUNK_SIZE; y++)
+    {
+        int cy = y < 0 ? 0 : (y < CHUNK_SIZE ? 1 : 2);
+        for (int z = -1; z <= CHUNK_SIZE; z++)
+        {
+            int cz = z < 0 ? 0 : (z < CHUNK_SIZE ? 1 : 2);
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                int cx = x < 0 ? 0 : (x < CHUNK_SIZE ? 1 : 2);
+                const Chunk* chunk = around[cy][cz][cx];
+                neighborhood.blocks[ChunkNeighborhood::index(x, y, z)] =
+                    chunk ? chunk->get(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK) : BLOCK_AIR;
+            }
+        }
+    }
+}
+
+// a face is visible unless the neighbour in front of it is opaque; touching faces of
+// the same transparent block (a wall of glass) are hidden as well
+inline bool isFaceVisible(BlockID id, BlockID neighbour)
+{
+    if (isOpaque(neighbour))
+        return false;
+    return neighbour != id;
+}
+
+// ambient occlusion of the four corners of a block face, from the blocks in front of the face
+// that touch each corner (two along the edges, one diagonal)
+inline void faceAO(const ChunkNeighborhood& chunk, const glm::ivec3& block, int face, int* ao)
+{
+    glm::ivec3 front = block + FACE_NORMALS[face];
+    int d = face / 2;
+    int a1 = (d + 1) % 3, a2 = (d + 2) % 3;
+    for (int c = 0; c < 4; c++)
+    {
+        glm::ivec3 side1 = front, side2 = front;
+        side1[a1] += FACE_CORNERS[face][c][a1] < 0.0f ? -1 : 1;
+        side2[a2] += FACE_CORNERS[face][c][a2] < 0.0f ? -1 : 1;
+        glm::ivec3 diagonal = side1;
+        diagonal[a2] = side2[a2];
+
+        bool s1 = isOpaque(chunk.get(side1.x, side1.y, side1.z));
+        bool s2 = isOpaque(chunk.get(side2.x, side2.y, side2.z));
+        bool corner = isOpaque(chunk.get(diagonal.x, diagonal.y, diagonal.z));
+        ao[c] = s1 && s2 ? 0 : 3 - (int)s1 - (int)s2 - (int)corner;
+    }
+}
+
+// the two mesh builders, selectable at runtime to compare vertex counts and frame times
+enum MeshMode
+{
+    MESH_NAIVE = 0, // one quad per visible block face
+    MESH_GREEDY     // coplanar neighbouring faces of the same block merged into larger quads
+};
+
+// bake every visible face of a chunk into one vertex array, one quad per block face
+// ------------------------------------------------------------------------
+inline void buildChunkMesh(const ChunkNeighborhood& chunk, ChunkMeshData& mesh)
+{
+    mesh.vertices.clear();
+    int ao[4];
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                BlockID id = chunk.get(x, y, z);
+                if (!isSolid(id)) continue;
+
+                glm::ivec3 block = glm::ivec3(x, y, z);
+                for (int face = 0; face < FACE_COUNT; face++)
+                {
+                    const glm::ivec3& n = FACE_NORMALS[face];
+                    if (!isFaceVisible(id, chunk.get(x + n.x, y + n.y, z + n.z))) continue;
+
+                    faceAO(chunk, block, face, ao);
+                    emitQuad(mesh.vertices, block, glm::ivec3(1, 1, 1), face, id, ao);
+                }
+            }
+        }
+    }
+}
+
+// same faces as buildChunkMesh, but every slice of the chunk is swept and rectangles of
+// visible faces with the same block id and the same corner occlusion are merged into one quad
+// ------------------------------------------------------------------------
+inline void buildChunkMeshGreedy(const ChunkNeighborhood& chunk, ChunkMeshData& mesh)
+{
+    mesh.vertices.clear();
+    // block id in the low byte, the four 2-bit corner occlusion values in the high byte, 0 = no face
+    std::uint16_t mask[CHUNK_SIZE * CHUNK_SIZE];
+    int ao[4];
+
+    for (int face = 0; face < FACE_COUNT; face++)
+    {
+        const glm::ivec3& n = FACE_NORMALS[face];
+        int d = face / 2;      // axis of the face normal
+        int u = (d + 1) % 3;   // the two axes spanning the slice
+        int v = (d + 2) % 3;
+
+        for (int slice = 0; slice < CHUNK_SIZE; slice++)
+        {
+            // which faces of this slice are visible, and of which block
+            glm::ivec3 p;
+            p[d] = slice;
+            for (int j = 0; j < CHUNK_SIZE; j++)
+            {
+                p[v] = j;
+                for (int i = 0; i < CHUNK_SIZE; i++)
+                {
+                    p[u] = i;
+                    std::uint16_t key = 0;
+                    BlockID id = chunk.get(p.x, p.y, p.z);
+                    if (isSolid(id) && isFaceVisible(id, chunk.get(p.x + n.x, p.y + n.y, p.z + n.z)))
+                    {
+                        faceAO(chunk, p, face, ao);
+                        key = (std::uint16_t)(id | ((ao[0] | (ao[1] << 2) | (ao[2] << 4) | (ao[3] << 6)) << 8));
+                    }
+                    mask[j * CHUNK_SIZE + i] = key;
+                }
+            }
+
+            // grow each unvisited face first along u, then along v while whole rows match
+            for (int j = 0; j < CHUNK_SIZE; j++)
+            {
+                for (int i = 0; i < CHUNK_SIZE; )
+                {
+                    std::uint16_t key = mask[j * CHUNK_SIZE + i];
+                    if (key == 0)
+                    {
+                        i++;
+                        continue;
+                    }
+
+                    int width = 1;
+                    while (i + width < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + width] == key)
+                        width++;
+
+                    int height = 1;
+                    for (; j + height < CHUNK_SIZE; height++)
+                    {
+                        bool rowMatches = true;
+                        for (int k = 0; k < width && rowMatches; k++)
+                            rowMatches = mask[(j + height) * CHUNK_SIZE + i + k] == key;
+                        if (!rowMatches) break;
+                    }
+
+                    for (int h = 0; h < height; h++)
+                        for (int k = 0; k < width; k++)
+                            mask[(j + h) * CHUNK_SIZE + i + k] = 0;
+
+                    glm::ivec3 start, size;
+                    start[d] = slice;
+                    start[u] = i;
+                    start[v] = j;
+                    size[d] = 1;
+                    size[u] = width;
+                    size[v] = height;
+
+                    BlockID id = (BlockID)(key & 0xFF);
+                    for (int c = 0; c < 4; c++)
+                        ao[c] = (key >> (8 + 2 * c)) & 3;
+                    emitQuad(mesh.vertices, start, size, face, id, ao);
+
+                    i += width;
+                }
+            }
+        }
+    }
+}
+
+inline void buildChunkMesh(const ChunkNeighborhood& chunk, ChunkMeshData& mesh, MeshMode mode)
+{
+    if (mode == MESH_GREEDY)
+        buildChunkMeshGreedy(chunk, mesh);
+    else
+        buildChunkMesh(chunk, mesh);
+}
+#endif
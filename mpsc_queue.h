@@ -0,0 +1,64 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// lock-free queue with any number of producer threads and a single consumer thread
+// (Vyukov's node based mpsc queue). push never blocks, pop returns false when empty
+// ------------------------------------------------------------------------
+template <class T>
+class MPSCQueue
+{
+public:
+    MPSCQueue()
+    {
+        Node* stub = new Node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+
+    ~MPSCQueue()
+    {
+        T value;
+        while (pop(value)) {}
+        delete tail;
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // can be called from any thread
+    // ------------------------------------------------------------------------
+    void push(T value)
+    {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // only ever called from the consumer thread
+    // ------------------------------------------------------------------------
+    bool pop(T& value)
+    {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+        value = std::move(next->value);
+        delete tail;
+        tail = next; // next becomes the new stub, its value has been moved out
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{ nullptr };
+        T value;
+    };
+
+    std::atomic<Node*> head; // last pushed node, producers swap themselves in here
+    Node* tail;              // stub node, the consumer reads the node after it
+};
+#endif
@@ -0,0 +1,300 @@
+#ifndef NOISE_GRID_H
+#define NOISE_GRID_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "PerlinNoise.hpp"
+
+// how a grid of noise compares to a threshold
+enum DensityRange
+{
+    DENSITY_BELOW, // no value is above the threshold
+    DENSITY_ABOVE, // every value is above the threshold
+    DENSITY_MIXED  // some are, some aren't
+};
+
+// fills regular grids of perlin noise by walking them lattice cell by lattice cell.
+// neighbouring samples share their lattice cell, so the floor, fade and fractional parts are worked
+// out once per grid column and row, and the eight corner hashes once per cell, instead of for
+// every sample. the per sample work is only the eight gradients and the lerps, which are done with
+// the same operations as BasicPerlinNoise::noise3D, so the values are exactly the scalar ones
+// ------------------------------------------------------------------------
+class NoiseGridSampler
+{
+public:
+    explicit NoiseGridSampler(const siv::BasicPerlinNoise<float>& noise) : p(noise.serialize()) {}
+
+    // out[row * width + column] = noise.octave2D((x0 + column) * scale, (y0 + row) * scale, octaves, persistence)
+    // ------------------------------------------------------------------------
+    void octave2D(float x0, float y0, float scale, int width, int height, int octaves, float persistence, float* out) const
+    {
+        for (int i = 0; i < width * height; i++)
+            out[i] = 0.0f;
+
+        std::vector<float> xs(width), ys(height);
+        for (int column = 0; column < width; column++)
+            xs[column] = (x0 + (float)column) * scale;
+        for (int row = 0; row < height; row++)
+            ys[row] = (y0 + (float)row) * scale;
+
+        // same accumulation as siv::perlin_detail::Octave2D, doubling the coordinates is exact
+        Axis ax, ay;
+        float amplitude = 1.0f;
+        for (int octave = 0; octave < octaves; octave++)
+        {
+            ax.build(xs.data(), width);
+            ay.build(ys.data(), height);
+            addNoise2D(ax, ay, amplitude, out);
+            for (float& x : xs) x *= 2;
+            for (float& y : ys) y *= 2;
+            amplitude *= persistence;
+        }
+    }
+
+    // 3D octave noise on a sizeX x sizeY x sizeZ block grid (out[(y * sizeZ + z) * sizeX + x]), evaluated
+    // only every step blocks and filled in with trilinear interpolation. a density field smooth enough
+    // for caves costs 1 / step^3 of the full evaluation, at the price of losing detail below step blocks
+    // ------------------------------------------------------------------------
+    void coarseOctave3D(float x0, float y0, float z0, float scale, int sizeX, int sizeY, int sizeZ, int step,
+                        int octaves, float persistence, const siv::BasicPerlinNoise<float>& noise, float* out) const
+    {
+        CoarseGrid grid(sizeX, sizeY, sizeZ, step);
+        grid.evaluate(x0, y0, z0, scale, octaves, persistence, noise, nullptr);
+        grid.interpolate(out);
+    }
+
+    // the same grid when only which side of threshold a block is on matters. every octave adds at most
+    // its amplitude, so once the octaves still to come (siv::perlin_detail::MaxAmplitude of them) can't
+    // move any corner across the threshold, and all corners are on the same side, the rest is skipped:
+    // the interpolated blocks lie between their corners, so the whole grid is on that side too.
+    // out is only filled for DENSITY_MIXED
+    // ------------------------------------------------------------------------
+    DensityRange coarseOctave3D(float x0, float y0, float z0, float scale, int sizeX, int sizeY, int sizeZ, int step,
+                                int octaves, float persistence, const siv::BasicPerlinNoise<float>& noise,
+                                float threshold, float* out) const
+    {
+        CoarseGrid grid(sizeX, sizeY, sizeZ, step);
+        DensityRange range = grid.evaluate(x0, y0, z0, scale, octaves, persistence, noise, &threshold);
+        if (range == DENSITY_MIXED)
+            grid.interpolate(out);
+        return range;
+    }
+
+private:
+    siv::BasicPerlinNoise<float>::state_type p;
+
+    // one grid axis: lattice cell, fractional position and fade of every sample along it
+    struct Axis
+    {
+        std::vector<int> cell;
+        std::vector<float> f, f1, fade;
+
+        void build(const float* coords, int count)
+        {
+            cell.resize(count);
+            f.resize(count);
+            f1.resize(count);
+            fade.resize(count);
+            for (int i = 0; i < count; i++)
+            {
+                float floored = std::floor(coords[i]);
+                cell[i] = (int)floored & 255;
+                f[i] = coords[i] - floored;
+                f1[i] = f[i] - 1;
+                fade[i] = siv::perlin_detail::Fade(f[i]);
+            }
+        }
+    };
+
+    static float lerp(float a, float b, float t)
+    {
+        return siv::perlin_detail::Lerp(a, b, t);
+    }
+
+    // the corners of the coarse cells of a 3D block grid, the last one along an axis may lie past the
+    // grid so every block has a cell around it
+    struct CoarseGrid
+    {
+        int sizeX, sizeY, sizeZ, step;
+        int cx, cy, cz;
+        std::vector<float> values;
+
+        CoarseGrid(int sizeX, int sizeY, int sizeZ, int step)
+            : sizeX(sizeX), sizeY(sizeY), sizeZ(sizeZ), step(step),
+              cx((sizeX - 1) / step + 2), cy((sizeY - 1) / step + 2), cz((sizeZ - 1) / step + 2),
+              values(cx * cy * cz, 0.0f) {}
+
+        // octave noise at every corner, all of them at once per octave through the batch api. with a
+        // threshold it stops as soon as every corner is known to be on the same side of it
+        DensityRange evaluate(float x0, float y0, float z0, float scale, int octaves, float persistence,
+                              const siv::BasicPerlinNoise<float>& noise, const float* threshold)
+        {
+            const int count = (int)values.size();
+            std::vector<float> xs(count), ys(count), zs(count), octave(count);
+            for (int y = 0; y < cy; y++)
+                for (int z = 0; z < cz; z++)
+                    for (int x = 0; x < cx; x++)
+                    {
+                        int i = (y * cz + z) * cx + x;
+                        xs[i] = (x0 + (float)(x * step)) * scale;
+                        ys[i] = (y0 + (float)(y * step)) * scale;
+                        zs[i] = (z0 + (float)(z * step)) * scale;
+                    }
+
+            float amplitude = 1.0f;
+            for (int o = 0; o < octaves; o++)
+            {
+                // the octaves left can still move a value by this much either way
+                const float remaining = amplitude * siv::perlin_detail::MaxAmplitude(octaves - o, persistence);
+                if (threshold)
+                {
+                    DensityRange range = classify(*threshold, remaining);
+                    if (range != DENSITY_MIXED)
+                        return range;
+                }
+
+                noise.noise3D(xs.data(), ys.data(), zs.data(), octave.data(), count);
+                for (int i = 0; i < count; i++)
+                {
+                    values[i] += octave[i] * amplitude;
+                    xs[i] *= 2;
+                    ys[i] *= 2;
+                    zs[i] *= 2;
+                }
+                amplitude *= persistence;
+            }
+            return threshold ? classify(*threshold, 0.0f) : DENSITY_MIXED;
+        }
+
+        DensityRange classify(float threshold, float remaining) const
+        {
+            bool allBelow = true, allAbove = true;
+            for (float value : values)
+            {
+                allBelow = allBelow && value + remaining <= threshold;
+                allAbove = allAbove && value - remaining > threshold;
+            }
+            return allBelow ? DENSITY_BELOW : allAbove ? DENSITY_ABOVE : DENSITY_MIXED;
+        }
+
+        // every block from the corners of its cell. trilinear interpolation one axis at a time, x, then z,
+        // then y: the same lerps as doing it per block, but the x and z ones are shared by whole rows
+        void interpolate(float* out) const
+        {
+            std::vector<float> alongX(cy * cz * sizeX), alongZ(cy * sizeZ * sizeX);
+            std::vector<int> cellX(sizeX), cellZ(sizeZ);
+            std::vector<float> tx(sizeX), tz(sizeZ);
+            axisWeights(sizeX, cellX.data(), tx.data());
+            axisWeights(sizeZ, cellZ.data(), tz.data());
+
+            for (int corner = 0; corner < cy * cz; corner++)
+            {
+                const float* c = &values[corner * cx];
+                for (int x = 0; x < sizeX; x++)
+                    alongX[corner * sizeX + x] = lerp(c[cellX[x]], c[cellX[x] + 1], tx[x]);
+            }
+            for (int y = 0; y < cy; y++)
+                for (int z = 0; z < sizeZ; z++)
+                {
+                    const float* c0 = &alongX[(y * cz + cellZ[z]) * sizeX];
+                    const float* c1 = c0 + sizeX;
+                    float* row = &alongZ[(y * sizeZ + z) * sizeX];
+                    for (int x = 0; x < sizeX; x++)
+                        row[x] = lerp(c0[x], c1[x], tz[z]);
+                }
+
+            const float inverseStep = 1.0f / (float)step;
+            const int layer = sizeZ * sizeX;
+            for (int y = 0; y < sizeY; y++)
+            {
+                const int cellY = y / step;
+                const float ty = (float)(y - cellY * step) * inverseStep;
+                const float* c0 = &alongZ[cellY * layer];
+                const float* c1 = c0 + layer;
+                for (int i = 0; i < layer; i++)
+                    out[y * layer + i] = lerp(c0[i], c1[i], ty);
+            }
+        }
+
+        // coarse cell and position inside it of every block along an axis
+        void axisWeights(int size, int* cell, float* t) const
+        {
+            const float inverseStep = 1.0f / (float)step;
+            for (int i = 0; i < size; i++)
+            {
+                cell[i] = i / step;
+                t[i] = (float)(i - cell[i] * step) * inverseStep;
+            }
+        }
+    };
+
+    // the corner gradients come from the same table as siv::perlin_detail::GradTable, looked up once per cell
+    typedef std::array<float, 3> Gradient;
+
+    static const Gradient& gradient(std::uint8_t hash)
+    {
+        return siv::perlin_detail::GradientTable<float>[hash & 15];
+    }
+
+    static float dot(const Gradient& g, float x, float y, float z)
+    {
+        return g[0] * x + g[1] * y + g[2] * z;
+    }
+
+    // out[row * width + column] += amplitude * noise2D at the samples of the two axes
+    // ------------------------------------------------------------------------
+    void addNoise2D(const Axis& ax, const Axis& ay, float amplitude, float* out) const
+    {
+        const int width = (int)ax.cell.size(), height = (int)ay.cell.size();
+
+        // noise2D samples the plane z = SIVPERLIN_DEFAULT_Z
+        const float z = static_cast<float>(SIVPERLIN_DEFAULT_Z);
+        const float floorZ = std::floor(z);
+        const int iz = (int)floorZ & 255;
+        const float fz = z - floorZ, fz1 = fz - 1;
+        const float w = siv::perlin_detail::Fade(fz);
+
+        Gradient g[8] = {};
+        int hashX = -1, hashY = -1;
+        for (int row = 0; row < height; row++)
+        {
+            const int iy = ay.cell[row];
+            const float fy = ay.f[row], fy1 = ay.f1[row], v = ay.fade[row];
+            for (int column = 0; column < width; column++)
+            {
+                const int ix = ax.cell[column];
+                if (ix != hashX || iy != hashY)
+                {
+                    // entered a new lattice cell, same hashing as noise3D
+                    const std::uint8_t A = (p[ix & 255] + iy) & 255;
+                    const std::uint8_t B = (p[(ix + 1) & 255] + iy) & 255;
+                    const std::uint8_t AA = (p[A] + iz) & 255;
+                    const std::uint8_t AB = (p[(A + 1) & 255] + iz) & 255;
+                    const std::uint8_t BA = (p[B] + iz) & 255;
+                    const std::uint8_t BB = (p[(B + 1) & 255] + iz) & 255;
+                    g[0] = gradient(p[AA]);
+                    g[1] = gradient(p[BA]);
+                    g[2] = gradient(p[AB]);
+                    g[3] = gradient(p[BB]);
+                    g[4] = gradient(p[(AA + 1) & 255]);
+                    g[5] = gradient(p[(BA + 1) & 255]);
+                    g[6] = gradient(p[(AB + 1) & 255]);
+                    g[7] = gradient(p[(BB + 1) & 255]);
+                    hashX = ix;
+                    hashY = iy;
+                }
+
+                const float fx = ax.f[column], fx1 = ax.f1[column], u = ax.fade[column];
+                const float q0 = lerp(dot(g[0], fx, fy, fz), dot(g[1], fx1, fy, fz), u);
+                const float q1 = lerp(dot(g[2], fx, fy1, fz), dot(g[3], fx1, fy1, fz), u);
+                const float q2 = lerp(dot(g[4], fx, fy, fz1), dot(g[5], fx1, fy, fz1), u);
+                const float q3 = lerp(dot(g[6], fx, fy1, fz1), dot(g[7], fx1, fy1, fz1), u);
+                out[row * width + column] += lerp(lerp(q0, q1, v), lerp(q2, q3, v), w) * amplitude;
+            }
+        }
+    }
+};
+#endif
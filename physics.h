@@ -0,0 +1,136 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "world.h"
+
+// axis aligned box in world space
+struct AABB
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// the player as a box standing on its feet, position is the centre of the bottom face
+// ------------------------------------------------------------------------
+struct PlayerBody
+{
+    static constexpr float HALF_WIDTH = 0.3f;
+    static constexpr float HEIGHT = 1.8f;
+    static constexpr float EYE_HEIGHT = 1.62f;
+
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 velocity = glm::vec3(0.0f);
+    bool onGround = false;
+
+    AABB bounds() const
+    {
+        return AABB{ position - glm::vec3(HALF_WIDTH, 0.0f, HALF_WIDTH),
+                     position + glm::vec3(HALF_WIDTH, HEIGHT, HALF_WIDTH) };
+    }
+
+    glm::vec3 eyePosition() const
+    {
+        return position + glm::vec3(0.0f, EYE_HEIGHT, 0.0f);
+    }
+};
+
+// true when the box and the block at cell share some volume
+inline bool overlapsBlock(const AABB& box, glm::ivec3 cell)
+{
+    for (int axis = 0; axis < 3; axis++)
+        if (box.max[axis] <= cell[axis] - 0.5f || box.min[axis] >= cell[axis] + 0.5f)
+            return false;
+    return true;
+}
+
+const float PLAYER_GRAVITY = -28.0f;
+const float PLAYER_TERMINAL_VELOCITY = -60.0f;
+const float PLAYER_JUMP_VELOCITY = 9.0f;
+// boxes are kept this far apart from blocks so rounding never leaves them overlapping
+const float COLLISION_EPSILON = 0.001f;
+
+// move the box along one axis by at most motion, stopping at the first solid block in the way.
+// only the cells covered by the box and the distance it moves are looked at
+// returns the distance actually moved
+// ------------------------------------------------------------------------
+inline float sweepAxis(const World& world, const AABB& box, int axis, float motion)
+{
+    if (motion == 0.0f) return 0.0f;
+    const float wanted = motion;
+
+    // cell i covers [i - 0.5, i + 0.5), blocks are centred on integer positions
+    glm::vec3 low = box.min, high = box.max;
+    if (motion > 0.0f) high[axis] += motion;
+    else low[axis] += motion;
+    glm::ivec3 first((int)std::floor(low.x + 0.5f), (int)std::floor(low.y + 0.5f), (int)std::floor(low.z + 0.5f));
+    glm::ivec3 last((int)std::floor(high.x + 0.5f), (int)std::floor(high.y + 0.5f), (int)std::floor(high.z + 0.5f));
+
+    for (int y = first.y; y <= last.y; y++)
+    {
+        for (int z = first.z; z <= last.z; z++)
+        {
+            for (int x = first.x; x <= last.x; x++)
+            {
+                glm::ivec3 cell(x, y, z);
+                if (!world.isSolidAt(cell)) continue;
+
+                // the box only touches the face of a block it overlaps on the two other axes
+                bool overlaps = true;
+                for (int other = 0; other < 3; other++)
+                {
+                    if (other == axis) continue;
+                    if (box.max[other] <= cell[other] - 0.5f || box.min[other] >= cell[other] + 0.5f)
+                        overlaps = false;
+                }
+                if (!overlaps) continue;
+
+                if (motion > 0.0f && box.max[axis] <= cell[axis] - 0.5f)
+                    motion = std::min(motion, cell[axis] - 0.5f - box.max[axis] - COLLISION_EPSILON);
+                else if (motion < 0.0f && box.min[axis] >= cell[axis] + 0.5f)
+                    motion = std::max(motion, cell[axis] + 0.5f - box.min[axis] + COLLISION_EPSILON);
+            }
+        }
+    }
+    // never move backwards because of the epsilon
+    return wanted > 0.0f ? std::max(motion, 0.0f) : std::min(motion, 0.0f);
+}
+
+// move the player by motion, resolving collisions one axis at a time (vertical first, so
+// walking into a wall while falling still lands). blocked axes lose their velocity
+// ------------------------------------------------------------------------
+inline void moveAndCollide(const World& world, PlayerBody& body, glm::vec3 motion)
+{
+    const int order[3] = { 1, 0, 2 };
+    body.onGround = false;
+    for (int axis : order)
+    {
+        float moved = sweepAxis(world, body.bounds(), axis, motion[axis]);
+        body.position[axis] += moved;
+        if (moved != motion[axis])
+        {
+            if (axis == 1 && motion[axis] < 0.0f)
+                body.onGround = true;
+            body.velocity[axis] = 0.0f;
+        }
+    }
+}
+
+// advance the player by deltaTime: walkVelocity is the wanted horizontal velocity from the input,
+// jump starts a jump when standing on the ground
+// ------------------------------------------------------------------------
+inline void stepPlayer(const World& world, PlayerBody& body, glm::vec3 walkVelocity, bool jump, float deltaTime)
+{
+    body.velocity.x = walkVelocity.x;
+    body.velocity.z = walkVelocity.z;
+    if (jump && body.onGround)
+        body.velocity.y = PLAYER_JUMP_VELOCITY;
+
+    body.velocity.y = std::max(body.velocity.y + PLAYER_GRAVITY * deltaTime, PLAYER_TERMINAL_VELOCITY);
+    moveAndCollide(world, body, body.velocity * deltaTime);
+}
+#endif
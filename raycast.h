@@ -0,0 +1,90 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <limits>
+
+#include "world.h"
+
+// result of a ray walking through the block grid
+struct RaycastHit
+{
+    glm::ivec3 block;    // first solid block on the ray
+    glm::ivec3 normal;   // face of that block the ray entered through, zero if the ray started inside it
+    glm::ivec3 previous; // last empty cell before the hit, where a new block would be placed
+    float distance;      // distance along the ray to the entered face
+    BlockID id;
+};
+
+// walk the cells a ray passes through, in order, until a solid block is found or maxDistance is
+// reached (Amanatides & Woo grid traversal). blocks are unit cubes centred on integer positions,
+// rayDir has to be normalized so maxDistance is in blocks
+// ------------------------------------------------------------------------
+inline bool raycastBlocks(const World& world, glm::vec3 rayStart, glm::vec3 rayDir, float maxDistance, RaycastHit* hit)
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // shift by half a block so cell i covers [i, i + 1) on every axis
+    glm::vec3 start = rayStart + glm::vec3(0.5f);
+    glm::ivec3 cell((int)std::floor(start.x), (int)std::floor(start.y), (int)std::floor(start.z));
+    glm::ivec3 previous = cell;
+    glm::ivec3 normal(0);
+
+    glm::ivec3 step;
+    glm::vec3 tMax;   // distance along the ray to the next cell boundary on each axis
+    glm::vec3 tDelta; // distance along the ray between two boundaries on each axis
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (rayDir[axis] > 0.0f)
+        {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / rayDir[axis];
+            tMax[axis] = (cell[axis] + 1 - start[axis]) * tDelta[axis];
+        }
+        else if (rayDir[axis] < 0.0f)
+        {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / rayDir[axis];
+            tMax[axis] = (start[axis] - cell[axis]) * tDelta[axis];
+        }
+        else
+        {
+            step[axis] = 0;
+            tDelta[axis] = infinity;
+            tMax[axis] = infinity;
+        }
+    }
+
+    float distance = 0.0f;
+    for (;;)
+    {
+        BlockID id = world.getBlock(cell);
+        if (isSolid(id))
+        {
+            hit->block = cell;
+            hit->normal = normal;
+            hit->previous = previous;
+            hit->distance = distance;
+            hit->id = id;
+            return true;
+        }
+
+        // step into the neighbour whose boundary is closest
+        int axis = 0;
+        if (tMax[1] < tMax[axis]) axis = 1;
+        if (tMax[2] < tMax[axis]) axis = 2;
+
+        distance = tMax[axis];
+        if (distance > maxDistance)
+            return false;
+
+        previous = cell;
+        cell[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+        normal = glm::ivec3(0);
+        normal[axis] = -step[axis];
+    }
+}
+#endif
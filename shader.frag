@@ -2,13 +2,14 @@
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in float Shade;
+flat in int Layer;
 
-// texture samplers
-uniform sampler2D texture1;
-uniform sampler2D texture2;
+// all block textures, one layer per material
+uniform sampler2DArray blockTextures;
 
 void main()
 {
-	// linearly interpolate between both textures (80% container, 20% awesomeface)
-	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
-}
\ No newline at end of file
+	vec4 color = texture(blockTextures, vec3(TexCoord, float(Layer)));
+	FragColor = vec4(color.rgb * Shade, color.a);
+}
@@ -5,6 +5,9 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -68,7 +71,8 @@ public:
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
-
+        // 3. look up every uniform location once, the setters only index this table
+        cacheUniforms();
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -76,66 +80,178 @@ public:
     {
         glUseProgram(ID);
     }
-    // utility uniform functions
+    // handle of a uniform, looked up once and then reused every frame
+    struct Uniform
+    {
+        int index = -1; // slot in the uniform table, -1 when the program has no such uniform
+    };
+    // ------------------------------------------------------------------------
+    Uniform uniform(std::string_view name) const
+    {
+        auto it = uniformIndex.find(std::string(name));
+        return it == uniformIndex.end() ? Uniform{} : Uniform{ it->second };
+    }
+    // ------------------------------------------------------------------------
+    GLint location(Uniform handle) const
+    {
+        // -1 is silently ignored by glUniform*, just like a name that does not exist
+        return handle.index < 0 ? -1 : uniforms[handle.index].location;
+    }
+    // utility uniform functions, by handle
+    // ------------------------------------------------------------------------
+    void setBool(Uniform handle, bool value) const
+    {
+        glUniform1i(location(handle), (int)value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(Uniform handle, int value) const
+    {
+        glUniform1i(location(handle), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(Uniform handle, float value) const
+    {
+        glUniform1f(location(handle), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec2(Uniform handle, const glm::vec2& value) const
+    {
+        glUniform2fv(location(handle), 1, &value[0]);
+    }
+    void setVec2(Uniform handle, float x, float y) const
+    {
+        glUniform2f(location(handle), x, y);
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(Uniform handle, const glm::vec3& value) const
+    {
+        glUniform3fv(location(handle), 1, &value[0]);
+    }
+    void setVec3(Uniform handle, float x, float y, float z) const
+    {
+        glUniform3f(location(handle), x, y, z);
+    }
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const
+    void setVec4(Uniform handle, const glm::vec4& value) const
+    {
+        glUniform4fv(location(handle), 1, &value[0]);
+    }
+    void setVec4(Uniform handle, float x, float y, float z, float w) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform4f(location(handle), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
+    void setMat2(Uniform handle, const glm::mat2& mat) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniformMatrix2fv(location(handle), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setMat3(Uniform handle, const glm::mat3& mat) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniformMatrix3fv(location(handle), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+    void setMat4(Uniform handle, const glm::mat4& mat) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniformMatrix4fv(location(handle), 1, GL_FALSE, &mat[0][0]);
     }
-    void setVec2(const std::string& name, float x, float y) const
+    // utility uniform functions, by name (a hash lookup in the uniform table, no driver call). for
+    // uniforms set every frame keep a Uniform from uniform() instead
+    // ------------------------------------------------------------------------
+    void setBool(std::string_view name, bool value) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        setBool(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void setInt(std::string_view name, int value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setInt(uniform(name), value);
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    // ------------------------------------------------------------------------
+    void setFloat(std::string_view name, float value) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        setFloat(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void setVec2(std::string_view name, const glm::vec2& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec2(uniform(name), value);
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w) const
+    void setVec2(std::string_view name, float x, float y) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        setVec2(uniform(name), x, y);
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void setVec3(std::string_view name, const glm::vec3& value) const
+    {
+        setVec3(uniform(name), value);
+    }
+    void setVec3(std::string_view name, float x, float y, float z) const
+    {
+        setVec3(uniform(name), x, y, z);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(std::string_view name, const glm::vec4& value) const
+    {
+        setVec4(uniform(name), value);
+    }
+    void setVec4(std::string_view name, float x, float y, float z, float w) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setVec4(uniform(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void setMat2(std::string_view name, const glm::mat2& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(uniform(name), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat3(std::string_view name, const glm::mat3& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(uniform(name), mat);
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(std::string_view name, const glm::mat4& mat) const
+    {
+        setMat4(uniform(name), mat);
     }
 
 private:
+    struct UniformEntry
+    {
+        std::string name;
+        GLint location;
+    };
+    // every active uniform of the program, filled once after linking
+    std::vector<UniformEntry> uniforms;
+    std::unordered_map<std::string, int> uniformIndex; // name -> slot in uniforms
+
+    // ------------------------------------------------------------------------
+    void cacheUniforms()
+    {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> buffer(maxLength > 0 ? maxLength : 1);
+        uniforms.reserve(count);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            // arrays are reported as "name[0]", look them up by their plain name
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                name.erase(name.size() - 3);
+            // uniforms inside uniform blocks have no location
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location >= 0)
+            {
+                uniformIndex[name] = (int)uniforms.size();
+                uniforms.push_back({ name, location });
+            }
+        }
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
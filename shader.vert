@@ -1,15 +1,41 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
+// chunk vertices packed into one integer, see packVertex() in mesher.h
+layout (location = 0) in uint aPacked;
 
 out vec2 TexCoord;
+out float Shade;
+flat out int Layer;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+// world space origin of the chunk owning every page of the vertex arena, see vertex_arena.h
+uniform isamplerBuffer chunkOrigins;
+// added on top, only the occlusion boxes use it
+uniform vec3 chunkOrigin;
+
+// brightness for ambient occlusion 0 (darkest) to 3 (unoccluded)
+const float aoShade[4] = float[4](0.45, 0.65, 0.82, 1.0);
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
-}
\ No newline at end of file
+	vec3 corner = vec3(float(aPacked & 31u), float((aPacked >> 5u) & 31u), float((aPacked >> 10u) & 31u));
+	uint face = (aPacked >> 15u) & 7u;
+	uint ao = (aPacked >> 18u) & 3u;
+	Layer = int((aPacked >> 20u) & 255u);
+
+	// the arena is handed out in pages of 256 vertices (ARENA_PAGE_SHIFT)
+	vec3 origin = vec3(texelFetch(chunkOrigins, gl_VertexID >> 8).xyz) + chunkOrigin;
+
+	// blocks are centered on integer positions, so corners sit half a block below them
+	gl_Position = projection * view * vec4(origin + corner - 0.5, 1.0f);
+
+	// texture coordinates follow the two axes spanning the face, one repeat per block
+	if (face == 0u)      TexCoord = vec2(corner.z, corner.y);
+	else if (face == 1u) TexCoord = vec2(-corner.z, corner.y);
+	else if (face == 2u) TexCoord = vec2(corner.x, corner.z);
+	else if (face == 3u) TexCoord = vec2(corner.x, -corner.z);
+	else if (face == 4u) TexCoord = vec2(-corner.x, corner.y);
+	else                 TexCoord = vec2(corner.x, corner.y);
+
+	Shade = aoShade[ao];
+}
@@ -0,0 +1,97 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <glm/glm.hpp>
+
+#include "world.h"
+#include "physics.h"
+
+// the simulation always advances in steps of this size, no matter how fast frames are rendered
+const int TICKS_PER_SECOND = 60;
+const float TICK_SECONDS = 1.0f / TICKS_PER_SECOND;
+// a frame never runs more ticks than this, the rest of a long hitch is dropped
+const int MAX_TICKS_PER_FRAME = 5;
+
+// what the player wants to do during one tick, sampled from the keyboard before the ticks run
+struct PlayerInput
+{
+    glm::vec3 walkVelocity = glm::vec3(0.0f); // horizontal, blocks per second
+    bool jump = false;
+};
+
+// turns variable frame times into a whole number of fixed ticks, the leftover time is kept
+// for the next frame and tells how far rendering is between the last two ticks
+// ------------------------------------------------------------------------
+class FixedTimestep
+{
+public:
+    // add the time the last frame took, returns how many ticks to run now
+    int advance(double frameSeconds)
+    {
+        accumulator += frameSeconds;
+        int ticks = (int)(accumulator / TICK_SECONDS);
+        if (ticks > MAX_TICKS_PER_FRAME)
+        {
+            ticks = MAX_TICKS_PER_FRAME;
+            accumulator = 0.0;
+            return ticks;
+        }
+        accumulator -= ticks * (double)TICK_SECONDS;
+        return ticks;
+    }
+
+    // 0 right after a tick, close to 1 just before the next one
+    float alpha() const
+    {
+        return (float)(accumulator / TICK_SECONDS);
+    }
+
+private:
+    double accumulator = 0.0;
+};
+
+// everything that moves on the fixed tick. it only reads the world, so it runs the same with or without a window
+// ------------------------------------------------------------------------
+class Simulation
+{
+public:
+    PlayerBody player;
+    glm::vec3 spawn = glm::vec3(0.0f);
+    unsigned long long tickCount = 0;
+
+    void reset(glm::vec3 spawnPosition)
+    {
+        spawn = spawnPosition;
+        player.position = spawn;
+        player.velocity = glm::vec3(0.0f);
+        previousPosition = spawn;
+    }
+
+    // advance one tick of TICK_SECONDS
+    // ------------------------------------------------------------------------
+    void tick(const World& world, const PlayerInput& input)
+    {
+        previousPosition = player.position;
+        stepPlayer(world, player, input.walkVelocity, input.jump, TICK_SECONDS);
+
+        // fell off the world, start over
+        if (player.position.y < -64.0f)
+        {
+            player.position = spawn;
+            player.velocity = glm::vec3(0.0f);
+            previousPosition = spawn;
+        }
+        tickCount++;
+    }
+
+    // eye position blended between the last two ticks, alpha comes from FixedTimestep
+    glm::vec3 interpolatedEye(float alpha) const
+    {
+        glm::vec3 position = previousPosition + (player.position - previousPosition) * alpha;
+        return position + glm::vec3(0.0f, PlayerBody::EYE_HEIGHT, 0.0f);
+    }
+
+private:
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+};
+#endif
@@ -0,0 +1,367 @@
+#ifndef SOFTWARE_OCCLUSION_H
+#define SOFTWARE_OCCLUSION_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "frustum.h"
+#include "world.h"
+#include "mesher.h"
+#include "thread_pool.h"
+
+// resolution of the software depth buffer, the window is 4:3 as well. a multiple of 4 wide so every
+// row is whole simd groups
+const int OCCLUSION_BUFFER_WIDTH = 160;
+const int OCCLUSION_BUFFER_HEIGHT = 120;
+// a box is only hidden when the occluders are at least this much nearer (as a factor of 1 / depth),
+// a chunk is never hidden by its own solid blocks because of rounding
+const float OCCLUSION_DEPTH_BIAS = 1.001f;
+
+// an axis aligned box in world space
+struct OcclusionBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// the parts of a chunk that block the view completely: runs of block layers without a single
+// transparent block, along each axis. a chunk that is opaque all the way through is one box
+// ------------------------------------------------------------------------
+inline void findOccluders(const ChunkNeighborhood& chunk, std::vector<OcclusionBox>& occluders)
+{
+    occluders.clear();
+    // opaque blocks in every layer along x, y and z
+    int layers[3][CHUNK_SIZE] = {};
+    int opaque = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                int isOpaqueBlock = (int)isOpaque(chunk.get(x, y, z));
+                layers[0][x] += isOpaqueBlock;
+                layers[1][y] += isOpaqueBlock;
+                layers[2][z] += isOpaqueBlock;
+                opaque += isOpaqueBlock;
+            }
+
+    // blocks are centred on their integer position
+    const glm::vec3 origin = glm::vec3(chunk.coord * CHUNK_SIZE) - 0.5f;
+    if (opaque == CHUNK_VOLUME)
+    {
+        occluders.push_back(OcclusionBox{ origin, origin + (float)CHUNK_SIZE });
+        return;
+    }
+
+    const int fullLayer = CHUNK_SIZE * CHUNK_SIZE;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int first = 0; first < CHUNK_SIZE; first++)
+        {
+            if (layers[axis][first] != fullLayer)
+                continue;
+            int last = first;
+            while (last + 1 < CHUNK_SIZE && layers[axis][last + 1] == fullLayer)
+                last++;
+
+            OcclusionBox box{ origin, origin + (float)CHUNK_SIZE };
+            box.min[axis] = origin[axis] + (float)first;
+            box.max[axis] = origin[axis] + (float)(last + 1);
+            occluders.push_back(box);
+            first = last;
+        }
+    }
+}
+
+// a small depth buffer the occluders are rasterized into on the cpu, then boxes are tested against
+// it. it holds 1 / depth of the nearest occluder per pixel (0 where there is none), that is linear
+// in screen space so triangles interpolate it exactly. occluders cover the pixels whose centre they
+// cover, rows are filled four pixels at a time with SSE2 (same switch as the frustum tests)
+// ------------------------------------------------------------------------
+class OcclusionBuffer
+{
+public:
+    void begin(const glm::mat4& projectionView, const glm::vec3& eye)
+    {
+        this->projectionView = projectionView;
+        this->eye = eye;
+        std::fill(depth, depth + OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT, 0.0f);
+    }
+
+    // only the faces turned towards the eye are drawn, they cover everything the box covers
+    // ------------------------------------------------------------------------
+    void drawOccluder(const OcclusionBox& box)
+    {
+        glm::vec4 corners[8];
+        transformCorners(box, corners);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            int side;
+            if (eye[axis] < box.min[axis])
+                side = 0;
+            else if (eye[axis] > box.max[axis])
+                side = 1;
+            else
+                continue;
+
+            // the four corners of the face, corner i has max x when bit 0 is set, y bit 1, z bit 2
+            const int u = 1 << ((axis + 1) % 3), v = 1 << ((axis + 2) % 3), w = side << axis;
+            const glm::vec4 quad[4] = { corners[w], corners[w | u], corners[w | u | v], corners[w | v] };
+            drawQuad(quad);
+        }
+    }
+
+    // true when every pixel the box can touch has an occluder in front of all of the box. boxes
+    // reaching behind the near plane or off the screen are never hidden
+    // ------------------------------------------------------------------------
+    bool isHidden(const OcclusionBox& box) const
+    {
+        glm::vec4 corners[8];
+        transformCorners(box, corners);
+
+        float minX = (float)OCCLUSION_BUFFER_WIDTH, minY = (float)OCCLUSION_BUFFER_HEIGHT, maxX = 0.0f, maxY = 0.0f;
+        float nearest = 0.0f;
+        for (const glm::vec4& corner : corners)
+        {
+            if (corner.z < -corner.w)
+                return false;
+            glm::vec3 screen = toScreen(corner);
+            minX = std::min(minX, screen.x);
+            minY = std::min(minY, screen.y);
+            maxX = std::max(maxX, screen.x);
+            maxY = std::max(maxY, screen.y);
+            nearest = std::max(nearest, screen.z);
+        }
+
+        const int x0 = std::max(0, (int)std::floor(minX));
+        const int y0 = std::max(0, (int)std::floor(minY));
+        const int x1 = std::min(OCCLUSION_BUFFER_WIDTH - 1, (int)std::ceil(maxX) - 1);
+        const int y1 = std::min(OCCLUSION_BUFFER_HEIGHT - 1, (int)std::ceil(maxY) - 1);
+        if (x0 > x1 || y0 > y1)
+            return false;
+
+        const float threshold = nearest * OCCLUSION_DEPTH_BIAS;
+        for (int y = y0; y <= y1; y++)
+        {
+            const float* row = depth + y * OCCLUSION_BUFFER_WIDTH;
+#if FRUSTUM_SIMD_X86
+            const __m128 limit = _mm_set1_ps(threshold);
+            for (int x = x0 & ~3; x <= x1; x += 4)
+            {
+                // lanes left of x0 or right of x1 don't count
+                int lanes = 0xF;
+                if (x < x0)
+                    lanes &= 0xF << (x0 - x);
+                if (x + 3 > x1)
+                    lanes &= 0xF >> (x + 3 - x1);
+                int nearer = _mm_movemask_ps(_mm_cmpgt_ps(_mm_load_ps(row + x), limit));
+                if ((~nearer & lanes) != 0)
+                    return false;
+            }
+#else
+            for (int x = x0; x <= x1; x++)
+                if (!(row[x] > threshold))
+                    return false;
+#endif
+        }
+        return true;
+    }
+
+private:
+    alignas(16) float depth[OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT];
+    glm::mat4 projectionView = glm::mat4(1.0f);
+    glm::vec3 eye = glm::vec3(0.0f);
+
+    void transformCorners(const OcclusionBox& box, glm::vec4* corners) const
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+            corners[i] = projectionView * glm::vec4(corner, 1.0f);
+        }
+    }
+
+    // buffer x, y and 1 / depth of a clip space position in front of the near plane
+    static glm::vec3 toScreen(const glm::vec4& clip)
+    {
+        const float inverseW = 1.0f / clip.w;
+        return glm::vec3((clip.x * inverseW * 0.5f + 0.5f) * (float)OCCLUSION_BUFFER_WIDTH,
+                         (clip.y * inverseW * 0.5f + 0.5f) * (float)OCCLUSION_BUFFER_HEIGHT, inverseW);
+    }
+
+    // clip against the near plane (z >= -w), the ground under the player reaches behind the camera
+    // and is the occluder that matters most underground. then a fan of triangles
+    // ------------------------------------------------------------------------
+    void drawQuad(const glm::vec4* quad)
+    {
+        glm::vec3 polygon[5];
+        int count = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            const glm::vec4& a = quad[i];
+            const glm::vec4& b = quad[(i + 1) % 4];
+            const float da = a.z + a.w, db = b.z + b.w;
+            if (da >= 0.0f)
+                polygon[count++] = toScreen(a);
+            if ((da >= 0.0f) != (db >= 0.0f))
+                polygon[count++] = toScreen(a + (b - a) * (da / (da - db)));
+        }
+        for (int i = 2; i < count; i++)
+            drawTriangle(polygon[0], polygon[i - 1], polygon[i]);
+    }
+
+    // ------------------------------------------------------------------------
+    void drawTriangle(glm::vec3 a, glm::vec3 b, glm::vec3 c)
+    {
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (area == 0.0f)
+            return;
+        // counter clockwise, so all three edge functions are positive inside
+        if (area < 0.0f)
+        {
+            std::swap(b, c);
+            area = -area;
+        }
+
+        const int x0 = std::max(0, (int)std::floor(std::min(a.x, std::min(b.x, c.x))));
+        const int y0 = std::max(0, (int)std::floor(std::min(a.y, std::min(b.y, c.y))));
+        const int x1 = std::min(OCCLUSION_BUFFER_WIDTH - 1, (int)std::ceil(std::max(a.x, std::max(b.x, c.x))));
+        const int y1 = std::min(OCCLUSION_BUFFER_HEIGHT - 1, (int)std::ceil(std::max(a.y, std::max(b.y, c.y))));
+        if (x0 > x1 || y0 > y1)
+            return;
+
+        // edge functions e = ex * x + ey * y + e0 of the edges opposite a, b and c, they are the
+        // barycentric weights of the corners times area
+        const float ax = b.y - c.y, ay = c.x - b.x, a0 = b.x * c.y - b.y * c.x;
+        const float bx = c.y - a.y, by = a.x - c.x, b0 = c.x * a.y - c.y * a.x;
+        const float cx = a.y - b.y, cy = b.x - a.x, c0 = a.x * b.y - a.y * b.x;
+        const float inverseArea = 1.0f / area;
+        const float zx = (ax * a.z + bx * b.z + cx * c.z) * inverseArea;
+        const float zy = (ay * a.z + by * b.z + cy * c.z) * inverseArea;
+        const float z0 = (a0 * a.z + b0 * b.z + c0 * c.z) * inverseArea;
+
+        for (int y = y0; y <= y1; y++)
+        {
+            const float py = (float)y + 0.5f;
+            float* row = depth + y * OCCLUSION_BUFFER_WIDTH;
+#if FRUSTUM_SIMD_X86
+            const __m128 rowA = _mm_set1_ps(ay * py + a0), rowB = _mm_set1_ps(by * py + b0), rowC = _mm_set1_ps(cy * py + c0);
+            const __m128 rowZ = _mm_set1_ps(zy * py + z0);
+            const __m128 zero = _mm_setzero_ps();
+            // pixels left of x0 in the first group are outside the triangle anyway
+            for (int x = x0 & ~3; x <= x1; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ax), px), rowA), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(bx), px), rowB), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(cx), px), rowC), zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zx), px), rowZ);
+                const __m128 current = _mm_load_ps(row + x);
+                const __m128 nearer = _mm_max_ps(current, z);
+                _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (int x = x0; x <= x1; x++)
+            {
+                const float px = (float)x + 0.5f;
+                if (ax * px + ay * py + a0 < 0.0f || bx * px + by * py + b0 < 0.0f || cx * px + cy * py + c0 < 0.0f)
+                    continue;
+                row[x] = std::max(row[x], zx * px + zy * py + z0);
+            }
+#endif
+        }
+    }
+};
+
+// software occlusion culling of chunks on a worker thread: the occluders and the chunk boxes of a
+// frame are collected on the main thread, begin() hands them to the worker and returns, finish()
+// waits for the chunks found hidden. start it as soon as the camera is known, the worker then runs
+// while the main thread (and the gpu with the previous frame) is busy with everything else
+// ------------------------------------------------------------------------
+class SoftwareOcclusion
+{
+public:
+    // only between finish() and begin(), the worker owns the inputs in between
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        finish();
+        occluders.clear();
+        candidates.clear();
+    }
+    void addOccluders(const std::vector<OcclusionBox>& boxes)
+    {
+        occluders.insert(occluders.end(), boxes.begin(), boxes.end());
+    }
+    void addCandidate(const glm::ivec3& coord, const OcclusionBox& box)
+    {
+        candidates.push_back(std::make_pair(coord, box));
+    }
+
+    // ------------------------------------------------------------------------
+    void begin(const glm::mat4& projectionView, const glm::vec3& eye)
+    {
+        finish();
+        worker.submit([this, projectionView, eye] { run(projectionView, eye); });
+    }
+
+    void finish()
+    {
+        worker.wait();
+    }
+
+    // results of the last finished run
+    // ------------------------------------------------------------------------
+    bool isHidden(const glm::ivec3& coord) const
+    {
+        return hidden.count(coord) != 0;
+    }
+    int hiddenCount() const
+    {
+        return (int)hidden.size();
+    }
+    int occluderCount() const
+    {
+        return (int)occluders.size();
+    }
+    // time the worker spent on the last run in milliseconds
+    double cost() const
+    {
+        return costMilliseconds;
+    }
+
+private:
+    OcclusionBuffer buffer;
+    std::vector<OcclusionBox> occluders;
+    std::vector<std::pair<glm::ivec3, OcclusionBox>> candidates;
+    std::unordered_set<glm::ivec3, ChunkCoordHash> hidden;
+    double costMilliseconds = 0.0;
+    // declared last, its thread is joined before the rest goes away
+    ThreadPool worker{ 1 };
+
+    void run(const glm::mat4& projectionView, const glm::vec3& eye)
+    {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point start = Clock::now();
+
+        buffer.begin(projectionView, eye);
+        for (const OcclusionBox& occluder : occluders)
+            buffer.drawOccluder(occluder);
+
+        hidden.clear();
+        for (const auto& candidate : candidates)
+            if (buffer.isHidden(candidate.second))
+                hidden.insert(candidate.first);
+
+        costMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+};
+#endif
@@ -0,0 +1,110 @@
+#ifndef STRUCTURES_H
+#define STRUCTURES_H
+
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+#include "world.h"
+
+// trees grown on grass by the terrain generator
+const int TREE_ATTEMPTS = 3;        // random spots tried per chunk column
+const int TREE_MIN_HEIGHT = 4;      // trunk blocks
+const int TREE_HEIGHT_RANGE = 3;    // extra trunk blocks at most
+const int TREE_CANOPY_RADIUS = 2;   // leaves reach this far from the trunk, so into the neighbouring columns too
+
+// one block of a structure at a world position. structures only ever fill air, a write never
+// replaces terrain or another structure's block
+struct BlockWrite
+{
+    glm::ivec3 position;
+    BlockID id;
+};
+
+// the blocks of a tree standing on the block at base
+// ------------------------------------------------------------------------
+inline void treeBlocks(const glm::ivec3& base, int trunkHeight, std::vector<BlockWrite>& blocks)
+{
+    const int top = base.y + trunkHeight;
+    // the trunk goes first so the leaves wrap around it
+    for (int y = base.y + 1; y <= top; y++)
+        blocks.push_back(BlockWrite{ glm::ivec3(base.x, y, base.z), BLOCK_WOOD });
+
+    // two wide layers around the top of the trunk, then two small ones above it
+    for (int y = top - 1; y <= top + 2; y++)
+    {
+        const int radius = y <= top ? TREE_CANOPY_RADIUS : 1;
+        for (int dz = -radius; dz <= radius; dz++)
+            for (int dx = -radius; dx <= radius; dx++)
+            {
+                // round off the corners
+                if (radius > 1 && dx * dx == radius * radius && dz * dz == radius * radius)
+                    continue;
+                if (y == top + 2 && dx != 0 && dz != 0)
+                    continue;
+                blocks.push_back(BlockWrite{ glm::ivec3(base.x + dx, y, base.z + dz), BLOCK_LEAF });
+            }
+    }
+}
+
+// structure blocks that belong to chunk columns other than the one that generated them. a tree near
+// the border of its column puts leaves into the neighbours; the blocks are kept with the column that
+// made them for as long as it is loaded, and handed to a neighbour whenever that one is (re)generated,
+// instead of generating the neighbour right away. writes only fill air and only leaves cross columns,
+// so the world comes out the same in any generation order
+// ------------------------------------------------------------------------
+class StructureQueue
+{
+public:
+    // the chunks of the column at (chunkX, chunkZ) just went into the world: give it the blocks its
+    // loaded neighbours have for it, and place the ones it has for its loaded neighbours
+    void columnGenerated(World& world, int chunkX, int chunkZ, const std::vector<BlockWrite>& outside)
+    {
+        const glm::ivec3 key = columnKey(chunkX, chunkZ);
+        // structures are smaller than a chunk, only the 8 columns around can reach into this one
+        for (int dz = -1; dz <= 1; dz++)
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                auto neighbour = columns.find(columnKey(chunkX + dx, chunkZ + dz));
+                if ((dx == 0 && dz == 0) || neighbour == columns.end())
+                    continue;
+                for (const BlockWrite& write : neighbour->second)
+                    if (targetColumn(write) == key)
+                        place(world, write);
+            }
+
+        for (const BlockWrite& write : outside)
+            if (columns.count(targetColumn(write)))
+                place(world, write);
+        columns[key] = outside;
+    }
+
+    // the column was dropped from the world, its blocks for the neighbours go with it
+    void columnUnloaded(int chunkX, int chunkZ)
+    {
+        columns.erase(columnKey(chunkX, chunkZ));
+    }
+
+    // the key of a chunk column, y is unused
+    static glm::ivec3 columnKey(int chunkX, int chunkZ)
+    {
+        return glm::ivec3(chunkX, 0, chunkZ);
+    }
+
+    static glm::ivec3 targetColumn(const BlockWrite& write)
+    {
+        return columnKey(write.position.x >> CHUNK_SHIFT, write.position.z >> CHUNK_SHIFT);
+    }
+
+    static void place(World& world, const BlockWrite& write)
+    {
+        if (world.getBlock(write.position) == BLOCK_AIR)
+            world.setBlock(write.position, write.id);
+    }
+
+private:
+    // every generated column with the blocks it has for its neighbours
+    std::unordered_map<glm::ivec3, std::vector<BlockWrite>, ChunkCoordHash> columns;
+};
+#endif
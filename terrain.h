@@ -0,0 +1,296 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "world.h"
+#include "thread_pool.h"
+#include "PerlinNoise.hpp"
+#include "noise_grid.h"
+#include "structures.h"
+
+// shape of the generated landscape
+const int TERRAIN_BASE_HEIGHT = 16;    // lowest possible surface
+const int TERRAIN_HEIGHT_RANGE = 32;   // surface varies between base and base + range
+const int TERRAIN_DIRT_DEPTH = 3;      // dirt layers below the grass
+const float TERRAIN_SCALE = 1.0f / 96.0f; // noise units per block, larger hills for smaller values
+const int TERRAIN_OCTAVES = 4;
+// chunk columns generated around the origin in every direction at startup
+const int TERRAIN_RADIUS = 4;
+
+// caves: underground blocks are carved out where the 3D cave density is above the threshold (a
+// fraction of the largest value the octaves can add up to). the density is only evaluated every
+// TERRAIN_CAVE_STEP blocks and interpolated in between
+const float TERRAIN_CAVE_SCALE = 1.0f / 32.0f;
+const int TERRAIN_CAVE_OCTAVES = 3;
+const float TERRAIN_CAVE_THRESHOLD = 0.25f;
+const int TERRAIN_CAVE_STEP = 8;
+// ores replace stone where their own density is above the threshold, rarer ores deeper down
+const float TERRAIN_ORE_SCALE = 1.0f / 10.0f;
+const int TERRAIN_ORE_OCTAVES = 1;
+const int TERRAIN_ORE_STEP = 4;
+const float TERRAIN_COAL_THRESHOLD = 0.45f;
+const float TERRAIN_IRON_THRESHOLD = 0.50f;    // below TERRAIN_IRON_DEPTH
+const float TERRAIN_DIAMOND_THRESHOLD = 0.56f; // below TERRAIN_DIAMOND_DEPTH
+const int TERRAIN_IRON_DEPTH = 28;
+const int TERRAIN_DIAMOND_DEPTH = 12;
+
+// what generating a chunk column gives: its non-empty chunks bottom to top, and the structure blocks
+// that fell into neighbouring columns (see StructureQueue)
+struct TerrainColumn
+{
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<BlockWrite> outside;
+};
+
+// builds the blocks of a chunk from a seed. the result only depends on the seed and the chunk
+// coordinate, never on which thread builds it or in which order, so generation can run on any
+// number of workers and still give the same world
+// ------------------------------------------------------------------------
+class TerrainGenerator
+{
+public:
+    explicit TerrainGenerator(unsigned int seed)
+        : noise(seed), caveNoise(seed + 1), oreNoise(seed + 2), sampler(noise), seed(seed) {}
+
+    unsigned int getSeed() const
+    {
+        return seed;
+    }
+
+    // y of the highest solid block of the column at (x, z)
+    // ------------------------------------------------------------------------
+    int surfaceHeight(int x, int z) const
+    {
+        return heightFromNoise(noise.octave2D(x * TERRAIN_SCALE, z * TERRAIN_SCALE, TERRAIN_OCTAVES));
+    }
+
+    // heights of all CHUNK_SIZE x CHUNK_SIZE columns of a chunk column, indexed z * CHUNK_SIZE + x.
+    // the whole grid goes through the grid sampler, which gives the same heights as surfaceHeight
+    // ------------------------------------------------------------------------
+    void heightmap(int chunkX, int chunkZ, int* heights) const
+    {
+        float octaves[CHUNK_SIZE * CHUNK_SIZE];
+        sampler.octave2D((float)(chunkX * CHUNK_SIZE), (float)(chunkZ * CHUNK_SIZE), TERRAIN_SCALE,
+            CHUNK_SIZE, CHUNK_SIZE, TERRAIN_OCTAVES, 0.5f, octaves);
+        for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+            heights[i] = heightFromNoise(octaves[i]);
+    }
+
+    // surface height for an octave noise value, like octave2D_01 remapped into the height range
+    static int heightFromNoise(float value)
+    {
+        return TERRAIN_BASE_HEIGHT + (int)(siv::perlin_detail::RemapClamp_01(value) * TERRAIN_HEIGHT_RANGE);
+    }
+
+    // the block at world y of a column whose surface is at height
+    static BlockID columnBlock(int y, int height)
+    {
+        if (y > height) return BLOCK_AIR;
+        if (y == 0) return BLOCK_BEDROCK;
+        if (y == height) return BLOCK_GRASS;
+        if (y > height - TERRAIN_DIRT_DEPTH) return BLOCK_DIRT;
+        return BLOCK_STONE;
+    }
+
+    // carve caves into and put ores in a chunk filled by columnBlock. both densities are coarse grids
+    // that give up as soon as their octaves can't reach the threshold anywhere in the chunk, so
+    // chunks without caves or ores cost only a few corner evaluations
+    // ------------------------------------------------------------------------
+    void carveChunk(Chunk& chunk) const
+    {
+        if (chunk.solidCount == 0)
+            return;
+        const float x0 = (float)(chunk.coord.x * CHUNK_SIZE);
+        const float y0 = (float)(chunk.coord.y * CHUNK_SIZE);
+        const float z0 = (float)(chunk.coord.z * CHUNK_SIZE);
+        float density[CHUNK_VOLUME];
+
+        const float oreMax = siv::perlin_detail::MaxAmplitude(TERRAIN_ORE_OCTAVES, 0.5f);
+        DensityRange ores = sampler.coarseOctave3D(x0, y0, z0, TERRAIN_ORE_SCALE, CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE,
+            TERRAIN_ORE_STEP, TERRAIN_ORE_OCTAVES, 0.5f, oreNoise, TERRAIN_COAL_THRESHOLD * oreMax, density);
+        if (ores == DENSITY_ABOVE)
+        {
+            // all above coal, the deeper ores still need the values
+            sampler.coarseOctave3D(x0, y0, z0, TERRAIN_ORE_SCALE, CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE,
+                TERRAIN_ORE_STEP, TERRAIN_ORE_OCTAVES, 0.5f, oreNoise, density);
+        }
+        if (ores != DENSITY_BELOW)
+        {
+            // stone to ore keeps the solid count, the blocks can be written directly. the ores a layer can
+            // hold are picked once per layer, thresholds that can't be reached there are left at infinity
+            const float never = std::numeric_limits<float>::infinity();
+            const float coal = TERRAIN_COAL_THRESHOLD * oreMax;
+            for (int y = 0; y < CHUNK_SIZE; y++)
+            {
+                const int worldY = (int)y0 + y;
+                const float diamond = worldY < TERRAIN_DIAMOND_DEPTH ? TERRAIN_DIAMOND_THRESHOLD * oreMax : never;
+                const float iron = worldY < TERRAIN_IRON_DEPTH ? TERRAIN_IRON_THRESHOLD * oreMax : never;
+                for (int i = y * CHUNK_SIZE * CHUNK_SIZE; i < (y + 1) * CHUNK_SIZE * CHUNK_SIZE; i++)
+                {
+                    const float value = density[i];
+                    const BlockID ore = value > diamond ? BLOCK_DIAMOND : value > iron ? BLOCK_IRON
+                                      : value > coal ? BLOCK_COAL : BLOCK_STONE;
+                    chunk.blocks[i] = chunk.blocks[i] == BLOCK_STONE ? ore : chunk.blocks[i];
+                }
+            }
+        }
+
+        const float caveMax = siv::perlin_detail::MaxAmplitude(TERRAIN_CAVE_OCTAVES, 0.5f);
+        const float caveThreshold = TERRAIN_CAVE_THRESHOLD * caveMax;
+        DensityRange caves = sampler.coarseOctave3D(x0, y0, z0, TERRAIN_CAVE_SCALE, CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE,
+            TERRAIN_CAVE_STEP, TERRAIN_CAVE_OCTAVES, 0.5f, caveNoise, caveThreshold, density);
+        if (caves == DENSITY_BELOW)
+            return;
+        if (caves == DENSITY_ABOVE)
+            std::fill(density, density + CHUNK_VOLUME, caveThreshold + 1.0f);
+
+        int carved = 0;
+        for (int i = 0; i < CHUNK_VOLUME; i++)
+        {
+            // the bedrock floor stays closed
+            const BlockID block = chunk.blocks[i];
+            const bool carve = isSolid(block) && block != BLOCK_BEDROCK && density[i] > caveThreshold;
+            chunk.blocks[i] = carve ? BLOCK_AIR : block;
+            carved += (int)carve;
+        }
+        chunk.solidCount -= carved;
+    }
+
+    // the chunk column at (chunkX, chunkZ): terrain, caves and ores, then the trees on top
+    // ------------------------------------------------------------------------
+    TerrainColumn generateColumn(int chunkX, int chunkZ) const
+    {
+        int heights[CHUNK_SIZE * CHUNK_SIZE];
+        heightmap(chunkX, chunkZ, heights);
+        int top = *std::max_element(heights, heights + CHUNK_SIZE * CHUNK_SIZE);
+
+        // indexed by chunk y until the trees are in, empty chunks are dropped at the end
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        for (int chunkY = 0; chunkY <= (top >> CHUNK_SHIFT); chunkY++)
+        {
+            // a fresh chunk is all air, fill it in index order and count the solid blocks once
+            std::unique_ptr<Chunk> chunk(new Chunk(glm::ivec3(chunkX, chunkY, chunkZ)));
+            int solid = 0;
+            for (int y = 0; y < CHUNK_SIZE; y++)
+                for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+                {
+                    BlockID block = columnBlock(chunkY * CHUNK_SIZE + y, heights[i]);
+                    chunk->blocks[y * CHUNK_SIZE * CHUNK_SIZE + i] = block;
+                    solid += (int)isSolid(block);
+                }
+            chunk->solidCount = solid;
+            carveChunk(*chunk);
+            chunks.push_back(std::move(chunk));
+        }
+
+        TerrainColumn column;
+        decorateColumn(chunkX, chunkZ, heights, chunks, column.outside);
+        for (std::unique_ptr<Chunk>& chunk : chunks)
+            if (chunk && chunk->solidCount > 0)
+                column.chunks.push_back(std::move(chunk));
+        return column;
+    }
+
+    // grow the trees of a chunk column. where they go only depends on the seed and the column, the
+    // blocks inside the column are written right away, the rest is handed back in outside
+    // ------------------------------------------------------------------------
+    void decorateColumn(int chunkX, int chunkZ, const int* heights, std::vector<std::unique_ptr<Chunk>>& chunks,
+                        std::vector<BlockWrite>& outside) const
+    {
+        // rng() % n like siv::perlin_detail::Random, the std distributions differ between standard libraries
+        std::mt19937 rng(seed ^ ((unsigned int)chunkX * 73856093u) ^ ((unsigned int)chunkZ * 83492791u));
+        std::vector<BlockWrite> blocks;
+        for (int attempt = 0; attempt < TREE_ATTEMPTS; attempt++)
+        {
+            const int x = (int)(rng() % CHUNK_SIZE), z = (int)(rng() % CHUNK_SIZE);
+            const int trunkHeight = TREE_MIN_HEIGHT + (int)(rng() % (TREE_HEIGHT_RANGE + 1));
+
+            // only on grass that is still there after the caves
+            const int height = heights[z * CHUNK_SIZE + x];
+            const Chunk* ground = chunks[height >> CHUNK_SHIFT].get();
+            if (ground->get(x, height & CHUNK_MASK, z) != BLOCK_GRASS)
+                continue;
+
+            blocks.clear();
+            treeBlocks(glm::ivec3(chunkX * CHUNK_SIZE + x, height, chunkZ * CHUNK_SIZE + z), trunkHeight, blocks);
+            for (const BlockWrite& write : blocks)
+            {
+                if ((write.position.x >> CHUNK_SHIFT) != chunkX || (write.position.z >> CHUNK_SHIFT) != chunkZ)
+                {
+                    outside.push_back(write);
+                    continue;
+                }
+                const int chunkY = write.position.y >> CHUNK_SHIFT;
+                if (chunkY >= (int)chunks.size())
+                    chunks.resize(chunkY + 1);
+                if (!chunks[chunkY])
+                    chunks[chunkY].reset(new Chunk(glm::ivec3(chunkX, chunkY, chunkZ)));
+                Chunk& chunk = *chunks[chunkY];
+                const int lx = write.position.x & CHUNK_MASK, ly = write.position.y & CHUNK_MASK, lz = write.position.z & CHUNK_MASK;
+                if (chunk.get(lx, ly, lz) == BLOCK_AIR)
+                    chunk.set(lx, ly, lz, write.id);
+            }
+        }
+    }
+
+private:
+    siv::BasicPerlinNoise<float> noise;
+    siv::BasicPerlinNoise<float> caveNoise;
+    siv::BasicPerlinNoise<float> oreNoise;
+    NoiseGridSampler sampler;
+    unsigned int seed;
+};
+
+// generate every chunk column within radius of the origin on the workers and hand the chunks to
+// the world. each job writes only its own slot, and the slots are inserted in a fixed order, so the
+// world comes out the same for any thread count. structure blocks for columns that don't exist yet
+// wait in structures. returns the number of chunks created
+// ------------------------------------------------------------------------
+inline int generateTerrain(World& world, const TerrainGenerator& generator, StructureQueue& structures,
+                           ThreadPool& workers, int radius = TERRAIN_RADIUS)
+{
+    const int width = radius * 2;
+    std::vector<TerrainColumn> columns(width * width);
+    for (int i = 0; i < width * width; i++)
+    {
+        int chunkX = i % width - radius;
+        int chunkZ = i / width - radius;
+        TerrainColumn* slot = &columns[i];
+        workers.submit([&generator, slot, chunkX, chunkZ] {
+            *slot = generator.generateColumn(chunkX, chunkZ);
+        });
+    }
+    workers.wait();
+
+    int created = 0;
+    for (int i = 0; i < width * width; i++)
+    {
+        for (std::unique_ptr<Chunk>& chunk : columns[i].chunks)
+        {
+            world.insertChunk(std::move(chunk));
+            created++;
+        }
+        structures.columnGenerated(world, i % width - radius, i / width - radius, columns[i].outside);
+    }
+    return created;
+}
+
+// a spot to drop the player in, standing on the highest block of the generated column at (x, z).
+// caves can open up the surface and trees grow on it, so this looks at the world rather than the heightmap
+inline glm::vec3 spawnPosition(const World& world, const TerrainGenerator& generator, int x, int z)
+{
+    int y = generator.surfaceHeight(x, z) + TREE_MIN_HEIGHT + TREE_HEIGHT_RANGE + 2;
+    while (y > 0 && !world.isSolidAt(x, y, z))
+        y--;
+    // the top face of the block is at y + 0.5
+    return glm::vec3((float)x, y + 1.0f, (float)z);
+}
+#endif
@@ -0,0 +1,187 @@
+#ifndef TEXT_BATCH_H
+#define TEXT_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string_view>
+#include <vector>
+
+#include "shader.h"
+
+// metrics of one glyph and where it lives in the atlas
+struct Character {
+    glm::ivec2   Size;      // Size of glyph
+    glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
+    unsigned int Advance;   // Horizontal offset to advance to next glyph (1/64 pixels)
+    glm::ivec2   AtlasPos;  // top left pixel of the glyph in the atlas
+    glm::vec2    UVMin;     // atlas coordinates of the top left corner
+    glm::vec2    UVMax;     // atlas coordinates of the bottom right corner
+};
+
+// all ascii glyphs packed into one texture, and every string of a frame drawn with one draw call.
+// glyphs are added while the font is loaded, then uploadAtlas() creates the texture
+// ------------------------------------------------------------------------
+class TextBatch
+{
+public:
+    static const int GLYPH_COUNT = 128;
+    static const int ATLAS_WIDTH = 1024;
+    static const int FLOATS_PER_VERTEX = 7; // <vec2 pos, vec2 tex, vec3 color>
+
+    // copy a rasterized 8 bit glyph bitmap into the atlas (shelf packing, left to right then down)
+    // ------------------------------------------------------------------------
+    void addGlyph(unsigned char c, int width, int rows, int pitch, const unsigned char* bitmap,
+                  int bearingX, int bearingY, unsigned int advance)
+    {
+        if (c >= GLYPH_COUNT) return;
+
+        if (shelfX + width > ATLAS_WIDTH)
+        {
+            shelfX = 0;
+            shelfY += shelfHeight + 1;
+            shelfHeight = 0;
+        }
+        if (shelfY + rows > atlasHeight)
+        {
+            atlasHeight = shelfY + rows;
+            atlasPixels.resize((size_t)ATLAS_WIDTH * atlasHeight, 0);
+        }
+        for (int row = 0; row < rows; row++)
+            for (int col = 0; col < width; col++)
+                atlasPixels[(size_t)(shelfY + row) * ATLAS_WIDTH + shelfX + col] = bitmap[row * pitch + col];
+
+        Character& ch = Characters[c];
+        ch.Size = glm::ivec2(width, rows);
+        ch.Bearing = glm::ivec2(bearingX, bearingY);
+        ch.Advance = advance;
+        ch.AtlasPos = glm::ivec2(shelfX, shelfY);
+
+        shelfX += width + 1; // one pixel gap so linear filtering never bleeds into the neighbour
+        if (rows > shelfHeight) shelfHeight = rows;
+    }
+
+    // create the atlas texture and the streaming vertex buffer, needs a current gl context
+    // ------------------------------------------------------------------------
+    void uploadAtlas()
+    {
+        if (atlasHeight == 0)
+        {
+            atlasHeight = 1;
+            atlasPixels.assign(ATLAS_WIDTH, 0);
+        }
+        for (Character& ch : Characters)
+        {
+            ch.UVMin = glm::vec2((float)ch.AtlasPos.x / ATLAS_WIDTH, (float)ch.AtlasPos.y / atlasHeight);
+            ch.UVMax = glm::vec2((float)(ch.AtlasPos.x + ch.Size.x) / ATLAS_WIDTH, (float)(ch.AtlasPos.y + ch.Size.y) / atlasHeight);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlasPixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        // the pixels live on the gpu now
+        std::vector<unsigned char>().swap(atlasPixels);
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(4 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    // queue a line of text, nothing is drawn until flush()
+    // ------------------------------------------------------------------------
+    void add(std::string_view text, float x, float y, float scale, const glm::vec3& color)
+    {
+        for (char c : text)
+        {
+            if ((unsigned char)c >= GLYPH_COUNT) continue;
+            const Character& ch = Characters[(unsigned char)c];
+
+            float xpos = x + ch.Bearing.x * scale;
+            float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+
+            float w = ch.Size.x * scale;
+            float h = ch.Size.y * scale;
+            if (w > 0.0f && h > 0.0f)
+            {
+                // the bitmap rows go top down, so the top of the quad samples UVMin.y
+                pushVertex(xpos,     ypos + h, ch.UVMin.x, ch.UVMin.y, color);
+                pushVertex(xpos,     ypos,     ch.UVMin.x, ch.UVMax.y, color);
+                pushVertex(xpos + w, ypos,     ch.UVMax.x, ch.UVMax.y, color);
+
+                pushVertex(xpos,     ypos + h, ch.UVMin.x, ch.UVMin.y, color);
+                pushVertex(xpos + w, ypos,     ch.UVMax.x, ch.UVMax.y, color);
+                pushVertex(xpos + w, ypos + h, ch.UVMax.x, ch.UVMin.y, color);
+            }
+            // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+            x += (ch.Advance >> 6) * scale;
+        }
+    }
+
+    // draw everything queued since the last flush with the text shader, returns the number of draw calls
+    // ------------------------------------------------------------------------
+    unsigned int flush(const Shader& shader)
+    {
+        if (vertices.empty()) return 0;
+
+        shader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+        // orphan the old storage so the driver never has to wait for last frame's draw
+        size_t bytes = vertices.size() * sizeof(float);
+        if (bytes > bufferCapacity)
+            bufferCapacity = bytes;
+        glBufferData(GL_ARRAY_BUFFER, bufferCapacity, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(vertices.size() / FLOATS_PER_VERTEX));
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        vertices.clear();
+        return 1;
+    }
+
+    // free the gl objects, must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void destroy()
+    {
+        glDeleteTextures(1, &atlasTexture);
+        glDeleteBuffers(1, &VBO);
+        glDeleteVertexArrays(1, &VAO);
+        atlasTexture = VBO = VAO = 0;
+    }
+
+private:
+    Character Characters[GLYPH_COUNT] = {};
+
+    std::vector<unsigned char> atlasPixels;
+    int atlasHeight = 0;
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+
+    unsigned int atlasTexture = 0;
+    unsigned int VAO = 0, VBO = 0;
+    size_t bufferCapacity = 0;
+    std::vector<float> vertices;
+
+    void pushVertex(float x, float y, float u, float v, const glm::vec3& color)
+    {
+        vertices.insert(vertices.end(), { x, y, u, v, color.x, color.y, color.z });
+    }
+};
+#endif
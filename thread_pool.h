@@ -0,0 +1,116 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads pulling jobs from a shared queue
+// ------------------------------------------------------------------------
+class ThreadPool
+{
+public:
+    // one thread per core, minus the one running the render loop
+    static unsigned int defaultThreadCount()
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    // terrain streaming and chunk meshing run at the same time whenever the player moves, so their
+    // pools split defaultThreadCount() between them instead of each taking all of it
+    static unsigned int terrainThreadCount()
+    {
+        return std::max(1u, defaultThreadCount() / 2);
+    }
+    static unsigned int meshThreadCount()
+    {
+        return std::max(1u, defaultThreadCount() - terrainThreadCount());
+    }
+
+    explicit ThreadPool(unsigned int threadCount = defaultThreadCount())
+    {
+        if (threadCount == 0)
+            threadCount = 1;
+        for (unsigned int i = 0; i < threadCount; i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    // jobs that have not started yet are dropped, running ones are finished
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            jobs.clear();
+        }
+        jobAvailable.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // ------------------------------------------------------------------------
+    void submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+            unfinished++;
+        }
+        jobAvailable.notify_one();
+    }
+
+    // block until every submitted job has finished
+    // ------------------------------------------------------------------------
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this] { return unfinished == 0; });
+    }
+
+    unsigned int size() const
+    {
+        return (unsigned int)workers.size();
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable allDone;
+    unsigned int unfinished = 0;
+    bool stopping = false;
+
+    void workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping)
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                unfinished--;
+            }
+            allDone.notify_all();
+        }
+    }
+};
+#endif
@@ -0,0 +1,209 @@
+#ifndef VERTEX_ARENA_H
+#define VERTEX_ARENA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "mesher.h"
+
+// the arena is handed out in pages of this many vertices. the chunk shader finds the origin of the
+// chunk a vertex belongs to by its page, gl_VertexID >> ARENA_PAGE_SHIFT (keep shader.vert in sync)
+const int ARENA_PAGE_SHIFT = 8;
+const int ARENA_PAGE_VERTICES = 1 << ARENA_PAGE_SHIFT;
+// pages the arena starts with (4 MB of packed vertices), it doubles whenever it runs out
+const int ARENA_INITIAL_PAGES = 4096;
+
+// one big vertex buffer all chunk meshes are suballocated from, so any set of chunks can be drawn
+// with a single multi draw call from a single vertex array. free pages are kept as runs in a
+// first fit free list, neighbouring runs are merged when pages come back. next to the vertices
+// a texture buffer holds the world space origin of the chunk that owns every page, since gl 3.3
+// has no draw id to tell the chunks of a multi draw apart
+// ------------------------------------------------------------------------
+class VertexArena
+{
+public:
+    static int pagesFor(int vertexCount)
+    {
+        return (vertexCount + ARENA_PAGE_VERTICES - 1) >> ARENA_PAGE_SHIFT;
+    }
+
+    // needs a current gl context
+    // ------------------------------------------------------------------------
+    void create(int pages = ARENA_INITIAL_PAGES)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &originBuffer);
+        glGenTextures(1, &originTexture);
+
+        capacity = pages;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * ARENA_PAGE_VERTICES * sizeof(PackedVertex), NULL, GL_DYNAMIC_DRAW);
+        bindVertexArray();
+
+        origins.assign(capacity, glm::ivec4(0));
+        glBindBuffer(GL_TEXTURE_BUFFER, originBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, origins.size() * sizeof(glm::ivec4), origins.data(), GL_DYNAMIC_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, originTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, originBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        freeRuns.clear();
+        freeRuns[0] = capacity;
+    }
+
+    // pages for a mesh whose vertices sit at origin in world space, returns the first vertex. the
+    // arena grows when no free run is large enough
+    // ------------------------------------------------------------------------
+    int allocate(int pages, const glm::ivec3& origin)
+    {
+        auto run = std::find_if(freeRuns.begin(), freeRuns.end(),
+            [pages](const std::pair<const int, int>& free) { return free.second >= pages; });
+        if (run == freeRuns.end())
+        {
+            grow(pages);
+            run = std::prev(freeRuns.end());
+        }
+
+        const int first = run->first;
+        const int left = run->second - pages;
+        freeRuns.erase(run);
+        if (left > 0)
+            freeRuns[first + pages] = left;
+
+        std::fill(origins.begin() + first, origins.begin() + first + pages, glm::ivec4(origin, 0));
+        glBindBuffer(GL_TEXTURE_BUFFER, originBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(glm::ivec4), pages * sizeof(glm::ivec4), &origins[first]);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        usedPages += pages;
+        return first << ARENA_PAGE_SHIFT;
+    }
+
+    // ------------------------------------------------------------------------
+    void free(int firstVertex, int pages)
+    {
+        if (pages == 0)
+            return;
+        usedPages -= pages;
+        releasePages(firstVertex >> ARENA_PAGE_SHIFT, pages);
+    }
+
+    void write(int firstVertex, const std::vector<PackedVertex>& vertices)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)firstVertex * sizeof(PackedVertex), vertices.size() * sizeof(PackedVertex), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    unsigned int vertexArray() const
+    {
+        return VAO;
+    }
+    // to be bound to the chunk shader's chunkOrigins sampler
+    unsigned int originTable() const
+    {
+        return originTexture;
+    }
+    int capacityPages() const
+    {
+        return capacity;
+    }
+    int allocatedPages() const
+    {
+        return usedPages;
+    }
+
+    // free the gl objects, must run while the context is still alive
+    // ------------------------------------------------------------------------
+    void destroy()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &originBuffer);
+        glDeleteTextures(1, &originTexture);
+        VAO = VBO = originBuffer = originTexture = 0;
+        freeRuns.clear();
+        origins.clear();
+        capacity = usedPages = 0;
+    }
+
+private:
+    unsigned int VAO = 0, VBO = 0;
+    unsigned int originBuffer = 0, originTexture = 0;
+    int capacity = 0;  // pages
+    int usedPages = 0;
+    std::map<int, int> freeRuns; // first page -> pages
+    std::vector<glm::ivec4> origins; // of every page, w unused
+
+    void bindVertexArray()
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // packed vertex attribute, an integer attribute so the bits reach the shader untouched
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(PackedVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // put a run back into the free list, merged with the runs right before and right after
+    void releasePages(int first, int pages)
+    {
+        auto next = freeRuns.lower_bound(first);
+        if (next != freeRuns.end() && next->first == first + pages)
+        {
+            pages += next->second;
+            next = freeRuns.erase(next);
+        }
+        if (next != freeRuns.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == first)
+            {
+                previous->second += pages;
+                return;
+            }
+        }
+        freeRuns[first] = pages;
+    }
+
+    // double the arena until pages more fit at the end, the vertices are copied on the gpu
+    // ------------------------------------------------------------------------
+    void grow(int pages)
+    {
+        // a free run at the end grows along with the arena
+        int tail = 0;
+        if (!freeRuns.empty() && std::prev(freeRuns.end())->first + std::prev(freeRuns.end())->second == capacity)
+            tail = std::prev(freeRuns.end())->second;
+        int newCapacity = capacity;
+        while (newCapacity - capacity + tail < pages)
+            newCapacity *= 2;
+
+        unsigned int newVBO = 0;
+        glGenBuffers(1, &newVBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity * ARENA_PAGE_VERTICES * sizeof(PackedVertex), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)capacity * ARENA_PAGE_VERTICES * sizeof(PackedVertex));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &VBO);
+        VBO = newVBO;
+        bindVertexArray();
+
+        origins.resize(newCapacity, glm::ivec4(0));
+        glBindBuffer(GL_TEXTURE_BUFFER, originBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, origins.size() * sizeof(glm::ivec4), origins.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        releasePages(capacity, newCapacity - capacity);
+        capacity = newCapacity;
+    }
+};
+#endif
@@ -0,0 +1,226 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "block.h"
+
+// chunks are CHUNK_SIZE blocks along every axis, CHUNK_SHIFT/CHUNK_MASK turn a world coordinate
+// into chunk + local coordinates without a division (also correct for negative coordinates)
+const int CHUNK_SHIFT = 4;
+const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+const int CHUNK_MASK = CHUNK_SIZE - 1;
+const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// a block at integer position (x, y, z) is a unit cube centered on that position
+inline glm::ivec3 worldToBlock(const glm::vec3& position)
+{
+    return glm::ivec3(glm::floor(position + 0.5f));
+}
+
+struct Chunk
+{
+    glm::ivec3 coord;             // chunk coordinate, the first block is at coord * CHUNK_SIZE
+    BlockID blocks[CHUNK_VOLUME]; // dense block storage, see index()
+    int solidCount;               // number of non-air blocks, lets empty chunks be skipped
+    bool dirty;                   // blocks changed since the mesh was last built
+
+    explicit Chunk(const glm::ivec3& chunkCoord) : coord(chunkCoord), solidCount(0), dirty(true)
+    {
+        std::memset(blocks, BLOCK_AIR, sizeof(blocks));
+    }
+
+    static int index(int x, int y, int z)
+    {
+        return (y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+    }
+
+    BlockID get(int x, int y, int z) const
+    {
+        return blocks[index(x, y, z)];
+    }
+
+    void set(int x, int y, int z, BlockID id)
+    {
+        BlockID& block = blocks[index(x, y, z)];
+        if (block == id)
+            return;
+        solidCount += (int)isSolid(id) - (int)isSolid(block);
+        block = id;
+        dirty = true;
+    }
+};
+
+struct ChunkCoordHash
+{
+    std::size_t operator()(const glm::ivec3& c) const
+    {
+        // large primes to spread neighbouring chunks across the buckets
+        return (std::size_t)(((unsigned int)c.x * 73856093u) ^ ((unsigned int)c.y * 19349663u) ^ ((unsigned int)c.z * 83492791u));
+    }
+};
+
+// the whole world: terrain and player placed blocks alike live in chunks keyed by chunk coordinate
+// ------------------------------------------------------------------------
+class World
+{
+public:
+    typedef std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, ChunkCoordHash> ChunkMap;
+
+    static glm::ivec3 chunkCoord(int x, int y, int z)
+    {
+        return glm::ivec3(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+    }
+
+    // ------------------------------------------------------------------------
+    BlockID getBlock(int x, int y, int z) const
+    {
+        const Chunk* chunk = getChunk(chunkCoord(x, y, z));
+        if (!chunk)
+            return BLOCK_AIR;
+        return chunk->get(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK);
+    }
+    BlockID getBlock(const glm::ivec3& position) const
+    {
+        return getBlock(position.x, position.y, position.z);
+    }
+    // ------------------------------------------------------------------------
+    void setBlock(int x, int y, int z, BlockID id)
+    {
+        glm::ivec3 coord = chunkCoord(x, y, z);
+        Chunk* chunk = getChunk(coord);
+        if (!chunk)
+        {
+            // no need to allocate a chunk just to store air in it
+            if (!isSolid(id))
+                return;
+            chunk = &createChunk(coord);
+        }
+
+        int lx = x & CHUNK_MASK, ly = y & CHUNK_MASK, lz = z & CHUNK_MASK;
+        if (chunk->get(lx, ly, lz) == id)
+            return;
+        chunk->set(lx, ly, lz, id);
+
+        // blocks on the chunk border also decide which faces the neighbouring chunks show and, through
+        // ambient occlusion, how the ones across an edge or corner are shaded
+        const glm::ivec3 low(lx == 0 ? -1 : 0, ly == 0 ? -1 : 0, lz == 0 ? -1 : 0);
+        const glm::ivec3 high(lx == CHUNK_MASK ? 1 : 0, ly == CHUNK_MASK ? 1 : 0, lz == CHUNK_MASK ? 1 : 0);
+        for (int dy = low.y; dy <= high.y; dy++)
+            for (int dz = low.z; dz <= high.z; dz++)
+                for (int dx = low.x; dx <= high.x; dx++)
+                    if (dx != 0 || dy != 0 || dz != 0)
+                        markDirty(coord + glm::ivec3(dx, dy, dz));
+    }
+    void setBlock(const glm::ivec3& position, BlockID id)
+    {
+        setBlock(position.x, position.y, position.z, id);
+    }
+    // ------------------------------------------------------------------------
+    bool isSolidAt(int x, int y, int z) const
+    {
+        return isSolid(getBlock(x, y, z));
+    }
+    bool isSolidAt(const glm::ivec3& position) const
+    {
+        return isSolid(getBlock(position));
+    }
+    // ------------------------------------------------------------------------
+    Chunk* getChunk(const glm::ivec3& coord)
+    {
+        auto it = chunks.find(coord);
+        return it == chunks.end() ? nullptr : it->second.get();
+    }
+    const Chunk* getChunk(const glm::ivec3& coord) const
+    {
+        auto it = chunks.find(coord);
+        return it == chunks.end() ? nullptr : it->second.get();
+    }
+    Chunk& createChunk(const glm::ivec3& coord)
+    {
+        std::unique_ptr<Chunk>& chunk = chunks[coord];
+        if (!chunk)
+        {
+            chunk.reset(new Chunk(coord));
+            extendColumn(coord);
+            markNeighboursDirty(coord);
+        }
+        return *chunk;
+    }
+    // take over a chunk that was filled somewhere else (e.g. on a terrain worker), replacing any chunk
+    // already at its coordinate
+    void insertChunk(std::unique_ptr<Chunk> chunk)
+    {
+        glm::ivec3 coord = chunk->coord;
+        chunk->dirty = true;
+        chunks[coord] = std::move(chunk);
+        extendColumn(coord);
+        markNeighboursDirty(coord);
+    }
+    // drop every chunk of the chunk column at (chunkX, chunkZ) and append their coordinates to removed.
+    // the chunks around them are marked dirty, their faces towards the gap are visible now
+    void removeColumn(int chunkX, int chunkZ, std::vector<glm::ivec3>& removed)
+    {
+        auto span = columnSpans.find(glm::ivec3(chunkX, 0, chunkZ));
+        if (span == columnSpans.end())
+            return;
+        size_t first = removed.size();
+        for (int chunkY = span->second.x; chunkY <= span->second.y; chunkY++)
+        {
+            auto it = chunks.find(glm::ivec3(chunkX, chunkY, chunkZ));
+            if (it == chunks.end())
+                continue;
+            removed.push_back(it->first);
+            chunks.erase(it);
+        }
+        columnSpans.erase(span);
+        for (size_t i = first; i < removed.size(); i++)
+            markNeighboursDirty(removed[i]);
+    }
+    // ------------------------------------------------------------------------
+    void markDirty(const glm::ivec3& coord)
+    {
+        Chunk* chunk = getChunk(coord);
+        if (chunk)
+            chunk->dirty = true;
+    }
+    // all 26 chunks around, the mesher reads the whole 3x3x3 neighbourhood for ambient occlusion
+    void markNeighboursDirty(const glm::ivec3& coord)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dz = -1; dz <= 1; dz++)
+                for (int dx = -1; dx <= 1; dx++)
+                    if (dx != 0 || dy != 0 || dz != 0)
+                        markDirty(coord + glm::ivec3(dx, dy, dz));
+    }
+    // ------------------------------------------------------------------------
+    ChunkMap& getChunks()
+    {
+        return chunks;
+    }
+    const ChunkMap& getChunks() const
+    {
+        return chunks;
+    }
+
+private:
+    ChunkMap chunks;
+    // column (x, 0, z) -> lowest and highest chunk y it ever held, so a column is dropped without
+    // walking every chunk
+    std::unordered_map<glm::ivec3, glm::ivec2, ChunkCoordHash> columnSpans;
+
+    void extendColumn(const glm::ivec3& coord)
+    {
+        auto span = columnSpans.emplace(glm::ivec3(coord.x, 0, coord.z), glm::ivec2(coord.y));
+        if (!span.second)
+            span.first->second = glm::ivec2(std::min(span.first->second.x, coord.y), std::max(span.first->second.y, coord.y));
+    }
+};
+#endif